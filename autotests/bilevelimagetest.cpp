@@ -0,0 +1,112 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by The Okular Developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QImage>
+#include <QTest>
+
+#include "../generators/fax/bilevelimage.h"
+
+class BilevelImageTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testCountPixels();
+    void testWhite();
+    void testBlack();
+    void testCheckerboard();
+    void testTile();
+};
+
+// a bilevel image where the set pixels are black, as in the fax generator
+static QImage bilevelImage(int width, int height)
+{
+    QImage image(width, height, QImage::Format_MonoLSB);
+    image.setColorTable({qRgb(255, 255, 255), qRgb(0, 0, 0)});
+    image.fill(0);
+    return image;
+}
+
+static QImage checkerboard(int width, int height)
+{
+    QImage image = bilevelImage(width, height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x)
+            image.setPixel(x, y, (x + y) % 2);
+    }
+    return image;
+}
+
+static bool isFilled(const QImage &image, QRgb color)
+{
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x) {
+            if (image.pixel(x, y) != color)
+                return false;
+        }
+    }
+    return true;
+}
+
+void BilevelImageTest::testCountPixels()
+{
+    const QImage image = checkerboard(200, 1);
+    const uchar *line = image.constScanLine(0);
+
+    QCOMPARE(BilevelImage::countPixels(line, 0, 200), 100);
+    QCOMPARE(BilevelImage::countPixels(line, 1, 2), 1);
+    QCOMPARE(BilevelImage::countPixels(line, 0, 1), 0);
+    QCOMPARE(BilevelImage::countPixels(line, 3, 150), 74);
+}
+
+void BilevelImageTest::testWhite()
+{
+    const QImage result = BilevelImage::scaled(bilevelImage(100, 80), 37, 29, QRect(0, 0, 37, 29));
+
+    QCOMPARE(result.size(), QSize(37, 29));
+    QVERIFY(isFilled(result, qRgb(255, 255, 255)));
+}
+
+void BilevelImageTest::testBlack()
+{
+    QImage image = bilevelImage(100, 80);
+    image.fill(1);
+    const QImage result = BilevelImage::scaled(image, 37, 29, QRect(0, 0, 37, 29));
+
+    QCOMPARE(result.size(), QSize(37, 29));
+    QVERIFY(isFilled(result, qRgb(0, 0, 0)));
+}
+
+void BilevelImageTest::testCheckerboard()
+{
+    // every pixel of the result covers 2x2 pixels of the image, half of them black
+    const QImage result = BilevelImage::scaled(checkerboard(64, 64), 32, 32, QRect(0, 0, 32, 32));
+
+    QCOMPARE(result.size(), QSize(32, 32));
+    const int gray = 255 - 2 * 255 / 4;
+    QVERIFY(isFilled(result, qRgb(gray, gray, gray)));
+}
+
+void BilevelImageTest::testTile()
+{
+    QImage image = checkerboard(300, 200);
+    for (int y = 50; y < 120; ++y) {
+        for (int x = 20; x < 250; ++x)
+            image.setPixel(x, y, 1);
+    }
+
+    const QImage full = BilevelImage::scaled(image, 170, 110, QRect(0, 0, 170, 110));
+    const QRect rect(13, 27, 91, 50);
+    const QImage tile = BilevelImage::scaled(image, 170, 110, rect);
+
+    QCOMPARE(tile, full.copy(rect));
+}
+
+QTEST_GUILESS_MAIN(BilevelImageTest)
+#include "bilevelimagetest.moc"
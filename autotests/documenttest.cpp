@@ -30,8 +30,38 @@ class DocumentTest : public QObject
 private slots:
     void testCloseDuringRotationJob();
     void testDocdataMigration();
+    void testOpenAsynchronously();
+    void testCloseWhileLoading();
+    void testLoadingFailed();
 };
 
+// Records the pages that the document sets up, to follow asynchronous loads
+class SetupObserver : public Okular::DocumentObserver
+{
+public:
+    void notifySetup(const QVector<Okular::Page *> &pages, int setupFlags) override
+    {
+        if (setupFlags & Okular::DocumentObserver::DocumentChanged) {
+            ++m_documentChanges;
+            m_pageCount = pages.count();
+        }
+    }
+
+    int m_documentChanges = 0;
+    int m_pageCount = -1;
+};
+
+// Writes a plain text file long enough to fill several pages
+static bool writeTextFile(QTemporaryFile *file)
+{
+    if (!file->open())
+        return false;
+    for (int i = 0; i < 2000; ++i)
+        file->write(QByteArrayLiteral("A line of text to lay out on the pages of the document.\n"));
+    file->close();
+    return true;
+}
+
 // Test that we don't crash if the document is closed while a RotationJob
 // is enqueued/running
 void DocumentTest::testCloseDuringRotationJob()
@@ -127,5 +157,105 @@ void DocumentTest::testDocdataMigration()
     delete m_document;
 }
 
+// Test that a document opened asynchronously starts with provisional pages,
+// and that the observers get the real ones once it is loaded
+void DocumentTest::testOpenAsynchronously()
+{
+    Okular::SettingsCore::instance(QStringLiteral("documenttest"));
+
+    QTemporaryFile textFile(QStringLiteral("%1/okrXXXXXX.txt").arg(QDir::tempPath()));
+    QVERIFY(writeTextFile(&textFile));
+    const QUrl textFileUrl = QUrl::fromLocalFile(textFile.fileName());
+    QMimeDatabase db;
+    const QMimeType mime = db.mimeTypeForFile(textFile.fileName());
+
+    Okular::Document *m_document = new Okular::Document(nullptr);
+
+    // the real page count, from a synchronous load of the same file
+    if (m_document->openDocument(textFile.fileName(), textFileUrl, mime) != Okular::Document::OpenSuccess)
+        QSKIP("The plain text generator is not available");
+    const int pageCount = m_document->pages();
+    QVERIFY(pageCount > 1);
+    m_document->closeDocument();
+
+    SetupObserver observer;
+    m_document->addObserver(&observer);
+    m_document->setOpenAsynchronously(true);
+    QCOMPARE(m_document->openDocument(textFile.fileName(), textFileUrl, mime), Okular::Document::OpenSuccess);
+    QCOMPARE(m_document->pages(), 1u);
+    const int documentChanges = observer.m_documentChanges;
+
+    QTRY_COMPARE_WITH_TIMEOUT(observer.m_documentChanges, documentChanges + 1, 10000);
+    QCOMPARE(observer.m_pageCount, pageCount);
+    QCOMPARE((int)m_document->pages(), pageCount);
+
+    m_document->closeDocument();
+    m_document->removeObserver(&observer);
+    delete m_document;
+}
+
+// Test that closing a document while it is loaded asynchronously drops what
+// is loaded meanwhile
+void DocumentTest::testCloseWhileLoading()
+{
+    Okular::SettingsCore::instance(QStringLiteral("documenttest"));
+
+    QTemporaryFile textFile(QStringLiteral("%1/okrXXXXXX.txt").arg(QDir::tempPath()));
+    QVERIFY(writeTextFile(&textFile));
+    QMimeDatabase db;
+    const QMimeType mime = db.mimeTypeForFile(textFile.fileName());
+
+    Okular::Document *m_document = new Okular::Document(nullptr);
+    SetupObserver observer;
+    m_document->addObserver(&observer);
+    m_document->setOpenAsynchronously(true);
+    if (m_document->openDocument(textFile.fileName(), QUrl::fromLocalFile(textFile.fileName()), mime) != Okular::Document::OpenSuccess)
+        QSKIP("The plain text generator is not available");
+
+    m_document->closeDocument();
+    QCOMPARE(m_document->pages(), 0u);
+    const int documentChanges = observer.m_documentChanges;
+
+    // the pages of the aborted load never reach the observers
+    QTest::qWait(500);
+    QCOMPARE(observer.m_documentChanges, documentChanges);
+    QCOMPARE(m_document->pages(), 0u);
+
+    m_document->removeObserver(&observer);
+    delete m_document;
+}
+
+// Test that a document that fails to load asynchronously is reported, and
+// left to be closed by who opened it
+void DocumentTest::testLoadingFailed()
+{
+    Okular::SettingsCore::instance(QStringLiteral("documenttest"));
+
+    // not XML, which the FictionBook converter only finds out when converting
+    QTemporaryFile badFile(QStringLiteral("%1/okrXXXXXX.fb2").arg(QDir::tempPath()));
+    QVERIFY(badFile.open());
+    badFile.write(QByteArrayLiteral("This is not a FictionBook document"));
+    badFile.close();
+    QMimeDatabase db;
+    const QMimeType mime = db.mimeTypeForFile(badFile.fileName(), QMimeDatabase::MatchExtension);
+
+    Okular::Document *m_document = new Okular::Document(nullptr);
+    SetupObserver observer;
+    m_document->addObserver(&observer);
+    m_document->setOpenAsynchronously(true);
+    QSignalSpy loadingFailedSpy(m_document, &Okular::Document::documentLoadingFailed);
+    if (m_document->openDocument(badFile.fileName(), QUrl::fromLocalFile(badFile.fileName()), mime) != Okular::Document::OpenSuccess)
+        QSKIP("The FictionBook generator is not available");
+    const int documentChanges = observer.m_documentChanges;
+
+    QTRY_COMPARE_WITH_TIMEOUT(loadingFailedSpy.count(), 1, 10000);
+    QCOMPARE(observer.m_documentChanges, documentChanges);
+    QVERIFY(m_document->isOpened());
+
+    m_document->closeDocument();
+    m_document->removeObserver(&observer);
+    delete m_document;
+}
+
 QTEST_MAIN(DocumentTest)
 #include "documenttest.moc"
@@ -14,8 +14,25 @@
 #include "generators/markdown/converter.h"
 #include <QMimeDatabase>
 #include <QMimeType>
+#include <QTemporaryFile>
 #include <QTextDocument>
 
+extern "C" {
+#include <mkdio.h>
+}
+
+#ifndef MKD_FENCEDCODE
+#define MKD_FENCEDCODE 0
+#endif
+
+#ifndef MKD_GITHUBTAGS
+#define MKD_GITHUBTAGS 0
+#endif
+
+#ifndef MKD_AUTOLINK
+#define MKD_AUTOLINK 0
+#endif
+
 class MarkdownTest : public QObject
 {
     Q_OBJECT
@@ -26,8 +43,11 @@ private slots:
     void testFancyPantsEnabled();
     void testFancyPantsDisabled();
     void testImageSizes();
+    void testSections_data();
+    void testSections();
 
 private:
+    QStringList findLinks(QTextDocument *document);
     void findImages(QTextFrame *parent, QVector<QTextImageFormat> &images);
     void findImages(const QTextBlock &parent, QVector<QTextImageFormat> &images);
 };
@@ -97,6 +117,64 @@ void MarkdownTest::testImageSizes()
     }
 }
 
+void MarkdownTest::testSections_data()
+{
+    QTest::addColumn<QByteArray>("markdown");
+
+    QTest::newRow("reference links") << QByteArray(
+        "# First\n\nA [link][one] and [another one][two].\n\n[one]: http://example.com/one\n\n"
+        "# Second\n\nThe [same link][one] again.\n\n[two]: http://example.com/two\n\n"
+        "# Third\n\nAnd the [second one][two].\n");
+    QTest::newRow("fenced code") << QByteArray(
+        "# First\n\n```\n# not a heading\n\n# still not a heading\n```\n\n"
+        "# Second\n\n~~~~\nfirst line\n\n# not a heading\n```\n\n# not a heading either\n~~~~\n\n"
+        "# Third\n\nText.\n");
+    QTest::newRow("raw html") << QByteArray(
+        "# First\n\n<pre>\nsome text\n\n# not a heading\n</pre>\n\n"
+        "# Second\n\n<div>\nmore text\n\n# not a heading\n</div>\n\n"
+        "# Third\n\nText.\n");
+}
+
+// Compares the conversion of the sections with the conversion of the whole file by discount
+void MarkdownTest::testSections()
+{
+    QFETCH(QByteArray, markdown);
+
+    QTemporaryFile file(QDir::tempPath() + QStringLiteral("/okularmarkdowntest-XXXXXX.md"));
+    QVERIFY(file.open());
+    file.write(markdown);
+    file.close();
+
+    Markdown::Converter converter;
+    QScopedPointer<QTextDocument> document(converter.convert(file.fileName()));
+    QVERIFY(document);
+
+    const int flags = MKD_FENCEDCODE | MKD_GITHUBTAGS | MKD_AUTOLINK | MKD_TOC | MKD_IDANCHOR;
+    MMIOT *markdownHandle = mkd_string(markdown.data(), markdown.size(), 0);
+    QVERIFY(mkd_compile(markdownHandle, flags));
+    char *htmlDocument;
+    const int size = mkd_document(markdownHandle, &htmlDocument);
+    QTextDocument expected;
+    expected.setHtml(QString::fromUtf8(htmlDocument, size));
+    mkd_cleanup(markdownHandle);
+
+    QCOMPARE(document->toPlainText().trimmed(), expected.toPlainText().trimmed());
+    QCOMPARE(findLinks(document.data()), findLinks(&expected));
+}
+
+QStringList MarkdownTest::findLinks(QTextDocument *document)
+{
+    QStringList links;
+    for (QTextBlock block = document->begin(); block.isValid(); block = block.next()) {
+        for (QTextBlock::iterator it = block.begin(); !it.atEnd(); ++it) {
+            const QTextCharFormat format = it.fragment().charFormat();
+            if (format.isAnchor() && !format.anchorHref().isEmpty())
+                links << format.anchorHref();
+        }
+    }
+    return links;
+}
+
 void MarkdownTest::findImages(QTextFrame *parent, QVector<QTextImageFormat> &images)
 {
     for (QTextFrame::iterator it = parent->begin(); !it.atEnd(); ++it) {
@@ -0,0 +1,371 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by The Okular Developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include <QApplication>
+#include <QMimeDatabase>
+#include <QPixmap>
+#include <QTemporaryDir>
+
+#include "../core/document.h"
+#include "../core/generator.h"
+#include "../core/observer.h"
+#include "../core/page.h"
+#include "../core/tile.h"
+#include "../core/tilesmanager_p.h"
+#include "../settings_core.h"
+#include "../ui/priorities.h"
+
+// how long to wait for a pixmap or a search before giving up
+#define BENCHMARK_TIMEOUT 60000
+
+Q_DECLARE_METATYPE(Okular::Document::SearchStatus)
+
+class PixmapObserver : public QObject, public Okular::DocumentObserver
+{
+    Q_OBJECT
+
+public:
+    void notifyPageChanged(int page, int flags) override
+    {
+        if (flags & Okular::DocumentObserver::Pixmap) {
+            m_pixmapPages.insert(page);
+            emit pixmapChanged();
+        }
+    }
+
+    bool waitForPixmap(int page)
+    {
+        if (m_pixmapPages.contains(page))
+            return true;
+
+        QEventLoop loop;
+        QTimer::singleShot(BENCHMARK_TIMEOUT, &loop, &QEventLoop::quit);
+        connect(this, &PixmapObserver::pixmapChanged, &loop, [this, page, &loop] {
+            if (m_pixmapPages.contains(page))
+                loop.quit();
+        });
+        loop.exec();
+        return m_pixmapPages.contains(page);
+    }
+
+    void clear()
+    {
+        m_pixmapPages.clear();
+    }
+
+signals:
+    void pixmapChanged();
+
+private:
+    QSet<int> m_pixmapPages;
+};
+
+class RenderBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void benchmarkTimeToFirstPixmap_data();
+    void benchmarkTimeToFirstPixmap();
+    void benchmarkScroll();
+    void benchmarkZoom();
+    void benchmarkSearch();
+    void benchmarkTextExtraction_data();
+    void benchmarkTextExtraction();
+    void benchmarkTilesManager();
+    void benchmarkEviction();
+
+private:
+    QString writeSyntheticPdf(int pages);
+    QString writeSyntheticText(int lines);
+    bool openDocument(const QString &fileName);
+    void documentFiles();
+    void resetPixmaps();
+
+    QTemporaryDir m_tempDir;
+    Okular::Document *m_document;
+    PixmapObserver *m_observer;
+};
+
+// Writes a PDF of @p pages pages with a few lines of text in the standard
+// Helvetica font each, so that it renders and extracts quickly
+QString RenderBenchmark::writeSyntheticPdf(int pages)
+{
+    const QString fileName = m_tempDir.filePath(QStringLiteral("synthetic-%1.pdf").arg(pages));
+    if (QFile::exists(fileName))
+        return fileName;
+
+    QByteArray pdf = "%PDF-1.4\n";
+    QVector<int> offsets;
+    auto addObject = [&pdf, &offsets](const QByteArray &object) {
+        offsets.append(pdf.size());
+        pdf += QByteArray::number(offsets.size()) + " 0 obj\n" + object + "\nendobj\n";
+    };
+
+    // objects 1, 2 and 3 are the catalog, the page tree and the font,
+    // then each page is followed by its content stream
+    QByteArray kids;
+    for (int i = 0; i < pages; ++i)
+        kids += QByteArray::number(4 + 2 * i) + " 0 R ";
+    addObject("<< /Type /Catalog /Pages 2 0 R >>");
+    addObject("<< /Type /Pages /Kids [" + kids + "] /Count " + QByteArray::number(pages) + " >>");
+    addObject("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>");
+    for (int i = 0; i < pages; ++i) {
+        QByteArray content = "BT /F1 24 Tf 72 720 Td (Page " + QByteArray::number(i + 1) + ") Tj /F1 12 Tf";
+        for (int line = 0; line < 40; ++line)
+            content += " 0 -15 Td (The quick brown fox jumps over the lazy dog, line " + QByteArray::number(line + 1) + ") Tj";
+        content += " ET";
+        addObject("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] /Resources << /Font << /F1 3 0 R >> >> /Contents " + QByteArray::number(5 + 2 * i) + " 0 R >>");
+        addObject("<< /Length " + QByteArray::number(content.size()) + " >>\nstream\n" + content + "\nendstream");
+    }
+
+    const int xrefOffset = pdf.size();
+    pdf += "xref\n0 " + QByteArray::number(offsets.size() + 1) + "\n0000000000 65535 f \n";
+    for (int offset : qAsConst(offsets))
+        pdf += QByteArray::number(offset).rightJustified(10, '0') + " 00000 n \n";
+    pdf += "trailer\n<< /Size " + QByteArray::number(offsets.size() + 1) + " /Root 1 0 R >>\nstartxref\n" + QByteArray::number(xrefOffset) + "\n%%EOF\n";
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(pdf) != pdf.size())
+        return QString();
+    return fileName;
+}
+
+QString RenderBenchmark::writeSyntheticText(int lines)
+{
+    const QString fileName = m_tempDir.filePath(QStringLiteral("synthetic-%1.txt").arg(lines));
+    if (QFile::exists(fileName))
+        return fileName;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return QString();
+    for (int line = 0; line < lines; ++line)
+        file.write("The quick brown fox jumps over the lazy dog, line " + QByteArray::number(line + 1) + '\n');
+    return fileName;
+}
+
+bool RenderBenchmark::openDocument(const QString &fileName)
+{
+    QMimeDatabase db;
+    const QMimeType mime = db.mimeTypeForFile(fileName);
+    return m_document->openDocument(fileName, QUrl(), mime) == Okular::Document::OpenSuccess;
+}
+
+// The documents of the data driven benchmarks, one for each of the most
+// common generators
+void RenderBenchmark::documentFiles()
+{
+    QTest::addColumn<QString>("fileName");
+
+    QTest::newRow("pdf") << writeSyntheticPdf(50);
+    QTest::newRow("txt") << writeSyntheticText(5000);
+    QTest::newRow("epub") << QStringLiteral(KDESRCDIR "data/contents.epub");
+    QTest::newRow("markdown") << QStringLiteral(KDESRCDIR "data/imageSizes.md");
+    QTest::newRow("image") << QStringLiteral(KDESRCDIR "data/potato.jpg");
+}
+
+// Drops the pixmaps of the observer, so that they are generated again
+void RenderBenchmark::resetPixmaps()
+{
+    m_document->removeObserver(m_observer);
+    m_observer->clear();
+    m_document->addObserver(m_observer);
+}
+
+void RenderBenchmark::initTestCase()
+{
+    Okular::SettingsCore::instance(QStringLiteral("renderbenchmark"));
+    QVERIFY(m_tempDir.isValid());
+}
+
+void RenderBenchmark::init()
+{
+    // keep every pixmap, so that the cache doesn't interfere with the measures
+    Okular::SettingsCore::setMemoryLevel(Okular::SettingsCore::EnumMemoryLevel::Greedy);
+
+    m_document = new Okular::Document(nullptr);
+    m_observer = new PixmapObserver;
+    m_document->addObserver(m_observer);
+}
+
+void RenderBenchmark::cleanup()
+{
+    m_document->closeDocument();
+    m_document->removeObserver(m_observer);
+    delete m_observer;
+    delete m_document;
+}
+
+void RenderBenchmark::benchmarkTimeToFirstPixmap_data()
+{
+    documentFiles();
+}
+
+// The time from opening a document to having the pixmap of its first page,
+// as when Okular is started on a document
+void RenderBenchmark::benchmarkTimeToFirstPixmap()
+{
+    QFETCH(QString, fileName);
+    if (!openDocument(fileName))
+        QSKIP("The generator of the document is not available");
+    m_document->closeDocument();
+
+    QBENCHMARK {
+        m_observer->clear();
+        QVERIFY(openDocument(fileName));
+        Okular::PixmapRequest *request = new Okular::PixmapRequest(m_observer, 0, 600, 800, PAGEVIEW_PRIO, Okular::PixmapRequest::Asynchronous);
+        m_document->requestPixmaps(QLinkedList<Okular::PixmapRequest *>() << request);
+        QVERIFY(m_observer->waitForPixmap(0));
+        m_document->closeDocument();
+    }
+}
+
+// Scrolls through the document a page at a time, requesting the visible page
+// and the preload ring around it as the page view does
+void RenderBenchmark::benchmarkScroll()
+{
+    const QString fileName = writeSyntheticPdf(200);
+    if (!openDocument(fileName))
+        QSKIP("The PDF generator is not available");
+
+    const int pages = m_document->pages();
+    QBENCHMARK {
+        resetPixmaps();
+        for (int page = 0; page < pages; ++page) {
+            m_document->setVisiblePageRects(QVector<Okular::VisiblePageRect *>() << new Okular::VisiblePageRect(page, Okular::NormalizedRect(0, 0, 1, 1)), m_observer);
+
+            QLinkedList<Okular::PixmapRequest *> requests;
+            requests << new Okular::PixmapRequest(m_observer, page, 600, 800, PAGEVIEW_PRIO, Okular::PixmapRequest::Asynchronous);
+            for (int ahead = page + 1; ahead <= qMin(page + 2, pages - 1); ++ahead)
+                requests << new Okular::PixmapRequest(m_observer, ahead, 600, 800, PAGEVIEW_PRELOAD_PRIO, Okular::PixmapRequest::Asynchronous | Okular::PixmapRequest::Preload);
+            if (page > 0)
+                requests << new Okular::PixmapRequest(m_observer, page - 1, 600, 800, PAGEVIEW_PRELOAD_BEHIND_PRIO, Okular::PixmapRequest::Asynchronous | Okular::PixmapRequest::Preload);
+            m_document->requestPixmaps(requests, Okular::Document::RemoveAllPrevious);
+
+            QVERIFY(m_observer->waitForPixmap(page));
+        }
+    }
+}
+
+// Renders the same page again at each zoom step
+void RenderBenchmark::benchmarkZoom()
+{
+    const QString fileName = writeSyntheticPdf(50);
+    if (!openDocument(fileName))
+        QSKIP("The PDF generator is not available");
+
+    QBENCHMARK {
+        resetPixmaps();
+        for (double zoom = 0.5; zoom <= 4.0; zoom *= 1.25) {
+            m_observer->clear();
+            Okular::PixmapRequest *request = new Okular::PixmapRequest(m_observer, 0, qRound(612 * zoom), qRound(792 * zoom), PAGEVIEW_PRIO, Okular::PixmapRequest::Asynchronous);
+            m_document->requestPixmaps(QLinkedList<Okular::PixmapRequest *>() << request, Okular::Document::RemoveAllPrevious);
+            QVERIFY(m_observer->waitForPixmap(0));
+        }
+    }
+}
+
+// Highlights all the matches of a word found on every page
+void RenderBenchmark::benchmarkSearch()
+{
+    qRegisterMetaType<Okular::Document::SearchStatus>();
+
+    const QString fileName = writeSyntheticPdf(200);
+    if (!openDocument(fileName))
+        QSKIP("The PDF generator is not available");
+
+    QSignalSpy searchFinishedSpy(m_document, &Okular::Document::searchFinished);
+    QBENCHMARK {
+        searchFinishedSpy.clear();
+        m_document->searchText(0, QStringLiteral("lazy"), true, Qt::CaseSensitive, Okular::Document::AllDocument, false, Qt::yellow);
+        QVERIFY(!searchFinishedSpy.isEmpty() || searchFinishedSpy.wait(BENCHMARK_TIMEOUT));
+        QCOMPARE(searchFinishedSpy.first().at(1).value<Okular::Document::SearchStatus>(), Okular::Document::MatchFound);
+        m_document->resetSearch(0);
+    }
+}
+
+void RenderBenchmark::benchmarkTextExtraction_data()
+{
+    documentFiles();
+}
+
+// Generates the text page of every page of the document
+void RenderBenchmark::benchmarkTextExtraction()
+{
+    QFETCH(QString, fileName);
+    if (!openDocument(fileName))
+        QSKIP("The generator of the document is not available");
+
+    const int pages = qMin<int>(m_document->pages(), 50);
+    QBENCHMARK {
+        for (int page = 0; page < pages; ++page)
+            m_document->requestTextPage(page);
+    }
+    QVERIFY(m_document->page(0)->hasTextPage() || !m_document->supportsSearching());
+}
+
+// Scrolls a viewport over a page at several zoom levels, filling the tiles
+// with the rendered viewport and freeing them as the memory cleanup does
+void RenderBenchmark::benchmarkTilesManager()
+{
+    const QSize viewport(1000, 800);
+    QPixmap viewportPixmap(viewport);
+    viewportPixmap.fill(Qt::white);
+
+    QBENCHMARK {
+        Okular::TilesManager tilesManager(0, 4000, 5000);
+        for (int width = 4000; width <= 8000; width += 2000) {
+            const int height = width * 5 / 4;
+            tilesManager.setSize(width, height);
+            for (int y = 0; y + viewport.height() <= height; y += viewport.height() / 2) {
+                const Okular::NormalizedRect visibleRect(QRect(QPoint(0, y), viewport), width, height);
+                tilesManager.setRequest(visibleRect, width, height);
+                tilesManager.setPixmap(&viewportPixmap, visibleRect, false);
+                QVERIFY(!tilesManager.tilesAt(visibleRect, Okular::TilesManager::PixmapTile).isEmpty());
+                tilesManager.cleanupPixmapMemory(4 * viewport.width() * viewport.height(), visibleRect, 0);
+            }
+        }
+    }
+}
+
+// Fills the pixmap cache with the pixmaps of 10000 pages, then evicts them
+// all to make room for a big one
+void RenderBenchmark::benchmarkEviction()
+{
+    const QString fileName = writeSyntheticPdf(10000);
+    if (!openDocument(fileName))
+        QSKIP("The PDF generator is not available");
+
+    // synchronous requests are generated recursively, so don't ask for too
+    // many at once
+    const int pages = m_document->pages();
+    for (int first = 0; first < pages; first += 100) {
+        QLinkedList<Okular::PixmapRequest *> requests;
+        for (int page = first; page < qMin(first + 100, pages); ++page)
+            requests << new Okular::PixmapRequest(m_observer, page, 32, 32, PAGEVIEW_PRIO, Okular::PixmapRequest::NoFeature);
+        m_document->requestPixmaps(requests);
+    }
+    QVERIFY(m_document->page(pages - 1)->hasPixmap(m_observer));
+
+    Okular::SettingsCore::setMemoryLevel(Okular::SettingsCore::EnumMemoryLevel::Low);
+    QBENCHMARK_ONCE {
+        Okular::PixmapRequest *request = new Okular::PixmapRequest(m_observer, 0, 1024, 1024, PAGEVIEW_PRIO, Okular::PixmapRequest::NoFeature);
+        m_document->requestPixmaps(QLinkedList<Okular::PixmapRequest *>() << request);
+    }
+    QVERIFY(!m_document->page(pages - 1)->hasPixmap(m_observer));
+}
+
+QTEST_MAIN(RenderBenchmark)
+#include "renderbenchmark.moc"
@@ -0,0 +1,92 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by The Okular Developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include "../render/renderutils.h"
+
+typedef QList<QPair<int, int>> PageRanges;
+
+Q_DECLARE_METATYPE(PageRanges)
+
+class RenderUtilsTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testParsePageRanges_data();
+    void testParsePageRanges();
+    void testPagesInRanges_data();
+    void testPagesInRanges();
+};
+
+void RenderUtilsTest::testParsePageRanges_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<bool>("valid");
+    QTest::addColumn<PageRanges>("ranges");
+
+    QTest::newRow("single page") << "3" << true << (PageRanges() << qMakePair(3, 3));
+    QTest::newRow("range") << "1-3" << true << (PageRanges() << qMakePair(1, 3));
+    QTest::newRow("open range") << "8-" << true << (PageRanges() << qMakePair(8, -1));
+    QTest::newRow("list") << "1-3,5,8-" << true << (PageRanges() << qMakePair(1, 3) << qMakePair(5, 5) << qMakePair(8, -1));
+    QTest::newRow("spaces") << " 2 - 4 , 6 " << true << (PageRanges() << qMakePair(2, 4) << qMakePair(6, 6));
+    QTest::newRow("empty parts") << "1,,2," << true << (PageRanges() << qMakePair(1, 1) << qMakePair(2, 2));
+    QTest::newRow("single page range") << "4-4" << true << (PageRanges() << qMakePair(4, 4));
+    QTest::newRow("empty") << "" << false << PageRanges();
+    QTest::newRow("only commas") << ",," << false << PageRanges();
+    QTest::newRow("reversed") << "5-3" << false << PageRanges();
+    QTest::newRow("zero") << "0" << false << PageRanges();
+    QTest::newRow("starting at zero") << "0-2" << false << PageRanges();
+    QTest::newRow("no first page") << "-3" << false << PageRanges();
+    QTest::newRow("not a number") << "a" << false << PageRanges();
+    QTest::newRow("not a number after a dash") << "1-b" << false << PageRanges();
+    QTest::newRow("one invalid") << "1,3-2" << false << PageRanges();
+}
+
+void RenderUtilsTest::testParsePageRanges()
+{
+    QFETCH(QString, text);
+    QFETCH(bool, valid);
+    QFETCH(PageRanges, ranges);
+
+    PageRanges parsed;
+    QCOMPARE(RenderUtils::parsePageRanges(text, &parsed), valid);
+    if (valid)
+        QCOMPARE(parsed, ranges);
+}
+
+void RenderUtilsTest::testPagesInRanges_data()
+{
+    QTest::addColumn<PageRanges>("ranges");
+    QTest::addColumn<int>("pageCount");
+    QTest::addColumn<QList<int>>("pages");
+
+    QTest::newRow("all pages") << PageRanges() << 3 << (QList<int>() << 0 << 1 << 2);
+    QTest::newRow("no pages") << PageRanges() << 0 << QList<int>();
+    QTest::newRow("range") << (PageRanges() << qMakePair(2, 3)) << 5 << (QList<int>() << 1 << 2);
+    QTest::newRow("open range") << (PageRanges() << qMakePair(4, -1)) << 5 << (QList<int>() << 3 << 4);
+    QTest::newRow("order of the ranges") << (PageRanges() << qMakePair(4, 4) << qMakePair(1, 2)) << 5 << (QList<int>() << 3 << 0 << 1);
+    QTest::newRow("duplicates") << (PageRanges() << qMakePair(1, 3) << qMakePair(2, 4)) << 5 << (QList<int>() << 0 << 1 << 2 << 3);
+    QTest::newRow("range past the end") << (PageRanges() << qMakePair(2, 10)) << 3 << (QList<int>() << 1 << 2);
+    QTest::newRow("page past the end") << (PageRanges() << qMakePair(7, 7)) << 3 << QList<int>();
+    QTest::newRow("open range past the end") << (PageRanges() << qMakePair(7, -1)) << 3 << QList<int>();
+}
+
+void RenderUtilsTest::testPagesInRanges()
+{
+    QFETCH(PageRanges, ranges);
+    QFETCH(int, pageCount);
+    QFETCH(QList<int>, pages);
+
+    QCOMPARE(RenderUtils::pagesInRanges(ranges, pageCount), pages);
+}
+
+QTEST_GUILESS_MAIN(RenderUtilsTest)
+#include "renderutilstest.moc"
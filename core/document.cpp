@@ -33,15 +33,21 @@
 #include <QApplication>
 #include <QDesktopServices>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QLabel>
+#include <QLibrary>
 #include <QMap>
 #include <QMimeDatabase>
 #include <QPageSize>
 #include <QPrintDialog>
 #include <QPrinter>
 #include <QRegularExpression>
+#include <QSaveFile>
 #include <QScreen>
 #include <QStack>
 #include <QStandardPaths>
@@ -87,6 +93,7 @@
 #include "page.h"
 #include "page_p.h"
 #include "pagecontroller_p.h"
+#include "rendertrace_p.h"
 #include "script/event_p.h"
 #include "scripter.h"
 #include "settings_core.h"
@@ -258,32 +265,34 @@ qulonglong DocumentPrivate::calculateMemoryToFree()
     // [MEM] choose memory parameters based on configuration profile
     qulonglong clipValue = 0;
     qulonglong memoryToFree = 0;
+    // text pages are accounted together with the pixmaps
+    const qulonglong allocatedMemory = m_allocatedPixmapsTotalMemory + m_allocatedTextPagesTotalMemory;
 
     switch (SettingsCore::memoryLevel()) {
     case SettingsCore::EnumMemoryLevel::Low:
-        memoryToFree = m_allocatedPixmapsTotalMemory;
+        memoryToFree = allocatedMemory;
         break;
 
     case SettingsCore::EnumMemoryLevel::Normal: {
         qulonglong thirdTotalMemory = getTotalMemory() / 3;
         qulonglong freeMemory = getFreeMemory();
-        if (m_allocatedPixmapsTotalMemory > thirdTotalMemory)
-            memoryToFree = m_allocatedPixmapsTotalMemory - thirdTotalMemory;
-        if (m_allocatedPixmapsTotalMemory > freeMemory)
-            clipValue = (m_allocatedPixmapsTotalMemory - freeMemory) / 2;
+        if (allocatedMemory > thirdTotalMemory)
+            memoryToFree = allocatedMemory - thirdTotalMemory;
+        if (allocatedMemory > freeMemory)
+            clipValue = (allocatedMemory - freeMemory) / 2;
     } break;
 
     case SettingsCore::EnumMemoryLevel::Aggressive: {
         qulonglong freeMemory = getFreeMemory();
-        if (m_allocatedPixmapsTotalMemory > freeMemory)
-            clipValue = (m_allocatedPixmapsTotalMemory - freeMemory) / 2;
+        if (allocatedMemory > freeMemory)
+            clipValue = (allocatedMemory - freeMemory) / 2;
     } break;
     case SettingsCore::EnumMemoryLevel::Greedy: {
         qulonglong freeSwap;
         qulonglong freeMemory = getFreeMemory(&freeSwap);
         const qulonglong memoryLimit = qMin(qMax(freeMemory, getTotalMemory() / 2), freeMemory + freeSwap);
-        if (m_allocatedPixmapsTotalMemory > memoryLimit)
-            clipValue = (m_allocatedPixmapsTotalMemory - memoryLimit) / 2;
+        if (allocatedMemory > memoryLimit)
+            clipValue = (allocatedMemory - memoryLimit) / 2;
     } break;
     }
 
@@ -295,14 +304,33 @@ qulonglong DocumentPrivate::calculateMemoryToFree()
 
 void DocumentPrivate::cleanupPixmapMemory()
 {
-    cleanupPixmapMemory(calculateMemoryToFree());
+    cleanupMemory(calculateMemoryToFree());
 }
 
-void DocumentPrivate::cleanupPixmapMemory(qulonglong memoryToFree)
+void DocumentPrivate::cleanupMemory(qulonglong memoryToFree)
 {
     if (memoryToFree < 1)
         return;
 
+    qCDebug(OkularCoreDebug).nospace() << "Memory in use: pixmaps=" << m_allocatedPixmapsTotalMemory << " text pages=" << m_allocatedTextPagesTotalMemory << " (" << m_allocatedTextPages.count() << " pages), to free=" << memoryToFree;
+
+    // Free the text pages that are at least as far from the current page as
+    // the first pixmap to evict, then the pixmaps, then the other text pages
+    const AllocatedPixmap *nextPixmap = searchLowestPriorityPixmap(true);
+    if (nextPixmap)
+        memoryToFree = cleanupTextPageMemory(memoryToFree, qAbs(nextPixmap->page - (*m_viewportIterator).pageNumber));
+    memoryToFree = cleanupPixmapMemory(memoryToFree);
+    cleanupTextPageMemory(memoryToFree);
+    RenderTrace::recordMemory(m_allocatedPixmapsTotalMemory, m_allocatedTextPagesTotalMemory);
+
+    qCDebug(OkularCoreDebug).nospace() << "Memory in use after cleanup: pixmaps=" << m_allocatedPixmapsTotalMemory << " text pages=" << m_allocatedTextPagesTotalMemory << " (" << m_allocatedTextPages.count() << " pages)";
+}
+
+qulonglong DocumentPrivate::cleanupPixmapMemory(qulonglong memoryToFree)
+{
+    if (memoryToFree < 1)
+        return 0;
+
     const int currentViewportPage = (*m_viewportIterator).pageNumber;
 
     // Create a QMap of visible rects, indexed by page number
@@ -334,6 +362,7 @@ void DocumentPrivate::cleanupPixmapMemory(qulonglong memoryToFree)
         // delete allocation descriptor
         delete p;
     }
+    RenderTrace::recordEvictions(pagesFreed);
 
     // If we're still on low memory, try to free individual tiles
 
@@ -378,6 +407,8 @@ void DocumentPrivate::cleanupPixmapMemory(qulonglong memoryToFree)
 
     m_allocatedPixmaps += pixmapsToKeep;
     // p--rintf("freeMemory A:[%d -%d = %d] \n", m_allocatedPixmaps.count() + pagesFreed, pagesFreed, m_allocatedPixmaps.count() );
+
+    return memoryToFree;
 }
 
 /* Returns the next pixmap to evict from cache, or NULL if no suitable pixmap
@@ -1008,8 +1039,8 @@ void DocumentPrivate::performAddPageAnnotation(int page, Annotation *annotation)
     notifyAnnotationChanges(page);
 
     if (annotation->flags() & Annotation::ExternallyDrawn) {
-        // Redraw everything, including ExternallyDrawn annotations
-        refreshPixmaps(page);
+        // Redraw the area of the annotation, including ExternallyDrawn annotations
+        refreshPixmaps(page, annotation->boundingRectangle());
     }
 }
 
@@ -1029,6 +1060,8 @@ void DocumentPrivate::performRemovePageAnnotation(int page, Annotation *annotati
     else
         isExternallyDrawn = false;
 
+    const NormalizedRect boundingRect = annotation->boundingRectangle();
+
     // try to remove the annotation
     if (m_parent->canRemovePageAnnotation(annotation)) {
         // tell the annotation proxy
@@ -1041,13 +1074,13 @@ void DocumentPrivate::performRemovePageAnnotation(int page, Annotation *annotati
         notifyAnnotationChanges(page);
 
         if (isExternallyDrawn) {
-            // Redraw everything, including ExternallyDrawn annotations
-            refreshPixmaps(page);
+            // Redraw the area the annotation was in
+            refreshPixmaps(page, boundingRect);
         }
     }
 }
 
-void DocumentPrivate::performModifyPageAnnotation(int page, Annotation *annotation, bool appearanceChanged)
+void DocumentPrivate::performModifyPageAnnotation(int page, Annotation *annotation, bool appearanceChanged, const NormalizedRect &oldBoundingRect)
 {
     Okular::SaveInterface *iface = qobject_cast<Okular::SaveInterface *>(m_generator);
     AnnotationProxy *proxy = iface ? iface->annotationProxy() : nullptr;
@@ -1076,9 +1109,13 @@ void DocumentPrivate::performModifyPageAnnotation(int page, Annotation *annotati
             m_annotationBeingModified = false;
         }
 
-        // Redraw everything, including ExternallyDrawn annotations
+        // Redraw the old and new areas of the annotation, or everything if
+        // the old area is unknown
         qCDebug(OkularCoreDebug) << "Refreshing Pixmaps";
-        refreshPixmaps(page);
+        if (oldBoundingRect.isNull())
+            refreshPixmaps(page);
+        else
+            refreshPixmaps(page, oldBoundingRect | annotation->boundingRectangle());
     }
 }
 
@@ -1111,7 +1148,7 @@ void DocumentPrivate::performSetAnnotationContents(const QString &newContents, A
     annot->setContents(newContents);
 
     // Tell the document the annotation has been modified
-    performModifyPageAnnotation(pageNumber, annot, appearanceChanged);
+    performModifyPageAnnotation(pageNumber, annot, appearanceChanged, annot->boundingRectangle());
 }
 
 void DocumentPrivate::recalculateForms()
@@ -1122,7 +1159,7 @@ void DocumentPrivate::recalculateForms()
         for (uint pageIdx = 0; pageIdx < m_parent->pages(); pageIdx++) {
             const Page *p = m_parent->page(pageIdx);
             if (p) {
-                bool pageNeedsRefresh = false;
+                NormalizedRect refreshRect;
                 foreach (FormField *form, p->formFields()) {
                     if (form->id() == formId) {
                         Action *action = form->additionalAction(FormField::CalculateField);
@@ -1153,7 +1190,7 @@ void DocumentPrivate::recalculateForms()
                                         m_parent->processFormatAction(action, fft);
                                     } else {
                                         emit m_parent->refreshFormWidget(fft);
-                                        pageNeedsRefresh = true;
+                                        refreshRect = refreshRect.isNull() ? fft->rect() : refreshRect | fft->rect();
                                     }
                                 }
                             }
@@ -1162,8 +1199,8 @@ void DocumentPrivate::recalculateForms()
                         }
                     }
                 }
-                if (pageNeedsRefresh) {
-                    refreshPixmaps(p->number());
+                if (!refreshRect.isNull()) {
+                    refreshPixmaps(p->number(), refreshRect);
                 }
             }
         }
@@ -1172,7 +1209,9 @@ void DocumentPrivate::recalculateForms()
 
 void DocumentPrivate::saveDocumentInfo() const
 {
-    if (m_xmlFileName.isEmpty())
+    // the provisional pages of a document that is still loading would
+    // overwrite the saved data of its pages
+    if (m_xmlFileName.isEmpty() || m_documentLoading)
         return;
 
     QFile infoFile(m_xmlFileName);
@@ -1261,7 +1300,7 @@ void DocumentPrivate::saveDocumentInfo() const
 void DocumentPrivate::slotTimedMemoryCheck()
 {
     // [MEM] clean memory (for 'free mem dependent' profiles only)
-    if (SettingsCore::memoryLevel() != SettingsCore::EnumMemoryLevel::Low && m_allocatedPixmapsTotalMemory > 1024 * 1024)
+    if (SettingsCore::memoryLevel() != SettingsCore::EnumMemoryLevel::Low && m_allocatedPixmapsTotalMemory + m_allocatedTextPagesTotalMemory > 1024 * 1024)
         cleanupPixmapMemory();
 }
 
@@ -1322,6 +1361,16 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
             m_pixmapRequestsStack.pop_back();
             delete r;
         }
+        // The refresh of an area of a page that is not tiled is drawn over the
+        // pixmap of the page, so it needs the pixmap at the requested size;
+        // otherwise, refresh the whole page
+        else if (r->d->mForce && r->isTile() && !tilesManager) {
+            if (!r->page()->hasPixmap(r->observer(), r->width(), r->height())) {
+                r->setTile(false);
+                r->setNormalizedRect(NormalizedRect());
+            }
+            request = r;
+        }
         // If the requested area is above 4*screenSize pixels, and we're not rendering most of the page,  switch on the tile manager
         else if (!tilesManager && m_generator->hasFeature(Generator::TiledRendering) && (long)r->width() * (long)r->height() > 4L * screenSize && normalizedArea < 0.75 && normalizedArea != 0) {
             // if the image is too big. start using tiles
@@ -1397,6 +1446,9 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
         return;
     }
 
+    if (request->isTile() && request->d->tilesManager())
+        splitTiledPixmapRequest(request);
+
     // [MEM] preventive memory freeing
     qulonglong pixmapBytes = 0;
     TilesManager *tm = request->d->tilesManager();
@@ -1406,7 +1458,7 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
         pixmapBytes = 4 * request->width() * request->height();
 
     if (pixmapBytes > (1024 * 1024))
-        cleanupPixmapMemory(memoryToFree /* previously calculated value */);
+        cleanupMemory(memoryToFree /* previously calculated value */);
 
     // submit the request to the generator
     if (m_generator->canGeneratePixmap()) {
@@ -1434,6 +1486,7 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
         // we can not really know if the generator can do async requests
         m_executingPixmapRequests.push_back(request);
         m_pixmapRequestsMutex.unlock();
+        request->d->mSentTime = RenderTrace::now();
         m_generator->generatePixmap(request);
     } else {
         m_pixmapRequestsMutex.unlock();
@@ -1442,6 +1495,50 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
     }
 }
 
+void DocumentPrivate::splitTiledPixmapRequest(PixmapRequest *request)
+{
+    const NormalizedRect requestRect = request->normalizedRect();
+    if (requestRect.isNull())
+        return;
+
+    TilesManager *tilesManager = request->d->tilesManager();
+    QList<NormalizedRect> tileRects;
+    const QList<Tile> tiles = tilesManager->tilesAt(requestRect, TilesManager::TerminalTile);
+    for (const Tile &tile : tiles) {
+        if (!tile.isValid() && !tilesManager->isRequesting(tile.rect(), request->width(), request->height()))
+            tileRects << tile.rect();
+    }
+
+    if (tileRects.count() < 2)
+        return;
+
+    // The tiles closest to the center of the requested area go last, as
+    // the last request of the stack is the first one to be generated
+    const NormalizedPoint center = requestRect.center();
+    auto distanceToCenter = [&center](const NormalizedRect &rect) {
+        const NormalizedPoint tileCenter = rect.center();
+        return qAbs(tileCenter.x - center.x) + qAbs(tileCenter.y - center.y);
+    };
+    std::sort(tileRects.begin(), tileRects.end(), [&distanceToCenter](const NormalizedRect &r1, const NormalizedRect &r2) { return distanceToCenter(r1) > distanceToCenter(r2); });
+
+    request->setNormalizedRect(tileRects.takeLast());
+
+    for (const NormalizedRect &tileRect : qAsConst(tileRects)) {
+        PixmapRequest *tileRequest = new PixmapRequest(request->observer(), request->pageNumber(), 0, 0, request->priority(), PixmapRequest::NoFeature);
+        tileRequest->d->mWidth = request->d->mWidth;
+        tileRequest->d->mHeight = request->d->mHeight;
+        tileRequest->d->mFeatures = request->d->mFeatures;
+        tileRequest->d->mForce = request->d->mForce;
+        tileRequest->d->mPartialUpdatesWanted = request->d->mPartialUpdatesWanted;
+        tileRequest->d->mPage = request->d->mPage;
+        tileRequest->setTile(true);
+        tileRequest->setNormalizedRect(tileRect);
+        tileRequest->d->mRequestedTime = request->d->mRequestedTime;
+        tileRequest->d->mQueuedTime = request->d->mQueuedTime;
+        m_pixmapRequestsStack.append(tileRequest);
+    }
+}
+
 void DocumentPrivate::rotationFinished(int page, Okular::Page *okularPage)
 {
     Okular::Page *wantedPage = m_pagesVector.value(page, 0);
@@ -1483,7 +1580,8 @@ void DocumentPrivate::slotGeneratorConfigChanged()
     QHash<QString, GeneratorInfo>::iterator it = m_loadedGenerators.begin(), itEnd = m_loadedGenerators.end();
     for (; it != itEnd; ++it) {
         Okular::ConfigInterface *iface = generatorConfig(it.value());
-        if (iface) {
+        // the generator of a document still loading applies its configuration later
+        if (iface && !(m_documentLoading && m_generator == it.value().generator)) {
             bool it_changed = iface->reparseConfig();
             if (it_changed && (m_generator == it.value().generator))
                 configchanged = true;
@@ -1510,18 +1608,39 @@ void DocumentPrivate::slotGeneratorConfigChanged()
         cleanupPixmapMemory();
 }
 
-void DocumentPrivate::refreshPixmaps(int pageNumber)
+void DocumentPrivate::refreshPixmaps(int pageNumber, const NormalizedRect &dirtyRect)
 {
     Page *page = m_pagesVector.value(pageNumber, 0);
     if (!page)
         return;
 
+    // The area to redraw, in the coordinates of the rotated page. It gets a
+    // small margin, since what is drawn for it may go slightly beyond it
+    // (e.g. borders and antialiasing).
+    NormalizedRect refreshRect;
+    if (!dirtyRect.isNull()) {
+        const double margin = 0.005;
+        const NormalizedRect rotatedRect = TilesManager::toRotatedRect(dirtyRect, page->rotation());
+        refreshRect = NormalizedRect(rotatedRect.left - margin, rotatedRect.top - margin, rotatedRect.right + margin, rotatedRect.bottom + margin) & NormalizedRect(0., 0., 1., 1.);
+    }
+
+    // Only an area of the page pixmaps is rendered again if the generator
+    // can render it alone; it is then drawn over the current pixmap
+    const bool canRefreshArea = !refreshRect.isNull() && m_generator->hasFeature(Generator::TiledRendering) && page->rotation() == Rotation0;
+
     QMap<DocumentObserver *, PagePrivate::PixmapObject>::ConstIterator it = page->d->m_pixmaps.constBegin(), itEnd = page->d->m_pixmaps.constEnd();
     QVector<Okular::PixmapRequest *> pixmapsToRequest;
     for (; it != itEnd; ++it) {
         const QSize size = (*it).m_pixmap->size();
         PixmapRequest *p = new PixmapRequest(it.key(), pageNumber, size.width() / qApp->devicePixelRatio(), size.height() / qApp->devicePixelRatio(), 1, PixmapRequest::Asynchronous);
         p->d->mForce = true;
+        if (canRefreshArea && !(*it).m_isPartialPixmap) {
+            // the area must match the current pixmap exactly
+            p->d->mWidth = size.width();
+            p->d->mHeight = size.height();
+            p->setNormalizedRect(refreshRect);
+            p->setTile(true);
+        }
         pixmapsToRequest << p;
     }
 
@@ -1538,7 +1657,10 @@ void DocumentPrivate::refreshPixmaps(int pageNumber)
 
         TilesManager *tilesManager = page->d->tilesManager(observer);
         if (tilesManager) {
-            tilesManager->markDirty();
+            if (refreshRect.isNull())
+                tilesManager->markDirty();
+            else
+                tilesManager->markDirty(refreshRect);
 
             PixmapRequest *p = new PixmapRequest(observer, pageNumber, tilesManager->width() / qApp->devicePixelRatio(), tilesManager->height() / qApp->devicePixelRatio(), 1, PixmapRequest::Asynchronous);
 
@@ -1552,6 +1674,11 @@ void DocumentPrivate::refreshPixmaps(int pageNumber)
                 }
             }
 
+            // Only the visible dirty tiles are requested, the other ones
+            // are requested when they get visible
+            if (!refreshRect.isNull() && !visibleRect.isNull())
+                visibleRect = visibleRect.intersects(refreshRect) ? visibleRect & refreshRect : NormalizedRect();
+
             if (!visibleRect.isNull()) {
                 p->setNormalizedRect(visibleRect);
                 p->setTile(true);
@@ -1570,10 +1697,7 @@ void DocumentPrivate::_o_configChanged()
 {
     // free text pages if needed
     calculateMaxTextPages();
-    while (m_allocatedTextPagesFifo.count() > m_maxAllocatedTextPages) {
-        int pageToKick = m_allocatedTextPagesFifo.takeFirst();
-        m_pagesVector.at(pageToKick)->setTextPage(nullptr); // deletes the textpage
-    }
+    cleanupTextPages(m_maxAllocatedTextPages);
 }
 
 void DocumentPrivate::doContinueDirectionMatchSearch(void *doContinueDirectionMatchSearchStruct)
@@ -1614,9 +1738,11 @@ void DocumentPrivate::doContinueDirectionMatchSearch(void *doContinueDirectionMa
     if (doContinue) {
         // get page
         Page *page = m_pagesVector[searchStruct->currentPage];
+        queueSearchTextPages(searchStruct->currentPage, forward);
         // request search page if needed
         if (!page->hasTextPage())
             m_parent->requestTextPage(page->number());
+        touchTextPage(page->number());
 
         // if found a match on the current page, end the loop
         searchStruct->match = page->findText(searchStruct->searchID, search->cachedString, forward ? FromTop : FromBottom, search->cachedCaseSensitivity);
@@ -1715,10 +1841,12 @@ void DocumentPrivate::doContinueAllDocumentSearch(void *pagesToNotifySet, void *
         // get page (from the first to the last)
         Page *page = m_pagesVector.at(currentPage);
         int pageNumber = page->number(); // redundant? is it == currentPage ?
+        queueSearchTextPages(pageNumber, true);
 
         // request search page if needed
         if (!page->hasTextPage())
             m_parent->requestTextPage(pageNumber);
+        touchTextPage(pageNumber);
 
         // loop on a page adding highlights for all found items
         RegularAreaRect *lastMatch = nullptr;
@@ -1808,10 +1936,12 @@ void DocumentPrivate::doContinueGooglesDocumentSearch(void *pagesToNotifySet, vo
         // get page (from the first to the last)
         Page *page = m_pagesVector.at(currentPage);
         int pageNumber = page->number(); // redundant? is it == currentPage ?
+        queueSearchTextPages(pageNumber, true);
 
         // request search page if needed
         if (!page->hasTextPage())
             m_parent->requestTextPage(pageNumber);
+        touchTextPage(pageNumber);
 
         // loop on a page adding highlights for all found items
         bool allMatched = wordCount > 0, anyMatched = false;
@@ -2192,11 +2322,116 @@ QString DocumentPrivate::docDataFileName(const QUrl &url, qint64 document_size)
     return newokularfile;
 }
 
+static QString generatorsCacheFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/okular/generators.json");
+}
+
+// The generator plugin files, with their size and modification time
+static QJsonArray generatorPluginFiles()
+{
+    QJsonArray result;
+    const QStringList libraryPaths = QCoreApplication::libraryPaths();
+    for (const QString &libraryPath : libraryPaths) {
+        const QDir dir(libraryPath + QStringLiteral("/okular/generators"));
+        const QFileInfoList entries = dir.entryInfoList(QDir::Files, QDir::Name);
+        for (const QFileInfo &entry : entries) {
+            if (!QLibrary::isLibrary(entry.fileName()))
+                continue;
+
+            QJsonObject file;
+            file[QStringLiteral("path")] = entry.absoluteFilePath();
+            file[QStringLiteral("size")] = entry.size();
+            file[QStringLiteral("modified")] = entry.lastModified().toMSecsSinceEpoch();
+            result.append(file);
+        }
+    }
+    return result;
+}
+
+static QVector<KPluginMetaData> loadCachedGenerators(const QJsonArray &pluginFiles)
+{
+    QFile cacheFile(generatorsCacheFileName());
+    if (!cacheFile.open(QIODevice::ReadOnly))
+        return QVector<KPluginMetaData>();
+
+    const QJsonObject cache = QJsonDocument::fromJson(cacheFile.readAll()).object();
+    if (cache.value(QStringLiteral("pluginFiles")).toArray() != pluginFiles)
+        return QVector<KPluginMetaData>();
+
+    QVector<KPluginMetaData> result;
+    const QJsonArray generators = cache.value(QStringLiteral("generators")).toArray();
+    for (const QJsonValue &generator : generators) {
+        const QJsonObject object = generator.toObject();
+        result << KPluginMetaData(object.value(QStringLiteral("metaData")).toObject(), object.value(QStringLiteral("fileName")).toString());
+    }
+    return result;
+}
+
+static void saveCachedGenerators(const QJsonArray &pluginFiles, const QVector<KPluginMetaData> &generators)
+{
+    QJsonArray generatorsArray;
+    for (const KPluginMetaData &md : generators) {
+        QJsonObject object;
+        object[QStringLiteral("fileName")] = md.fileName();
+        object[QStringLiteral("metaData")] = md.rawData();
+        generatorsArray.append(object);
+    }
+
+    QJsonObject cache;
+    cache[QStringLiteral("pluginFiles")] = pluginFiles;
+    cache[QStringLiteral("generators")] = generatorsArray;
+
+    const QString fileName = generatorsCacheFileName();
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile cacheFile(fileName);
+    if (cacheFile.open(QIODevice::WriteOnly)) {
+        cacheFile.write(QJsonDocument(cache).toJson(QJsonDocument::Compact));
+        cacheFile.commit();
+    }
+}
+
 QVector<KPluginMetaData> DocumentPrivate::availableGenerators()
 {
     static QVector<KPluginMetaData> result;
     if (result.isEmpty()) {
-        result = KPluginLoader::findPlugins(QStringLiteral("okular/generators"));
+        // Reading the metadata of every plugin file is slow, so it is cached
+        // on disk; the cache is discarded when any plugin file is added,
+        // removed or modified
+        const QJsonArray pluginFiles = generatorPluginFiles();
+        if (!pluginFiles.isEmpty())
+            result = loadCachedGenerators(pluginFiles);
+        if (result.isEmpty()) {
+            result = KPluginLoader::findPlugins(QStringLiteral("okular/generators"));
+            if (!pluginFiles.isEmpty())
+                saveCachedGenerators(pluginFiles, result);
+        }
+    }
+    return result;
+}
+
+struct GeneratorMimeTypes {
+    KPluginMetaData metaData;
+    // the names of the supported mimetypes, with aliases resolved
+    QStringList mimeTypes;
+};
+
+static const QVector<GeneratorMimeTypes> &generatorMimeTypes()
+{
+    static QVector<GeneratorMimeTypes> result;
+    if (result.isEmpty()) {
+        QMimeDatabase mimeDatabase;
+        const QVector<KPluginMetaData> available = DocumentPrivate::availableGenerators();
+        for (const KPluginMetaData &md : available) {
+            GeneratorMimeTypes generator;
+            generator.metaData = md;
+            const QStringList mimetypes = md.mimeTypes();
+            for (const QString &supported : mimetypes) {
+                const QMimeType mimeType = mimeDatabase.mimeTypeForName(supported);
+                generator.mimeTypes << (mimeType.isValid() ? mimeType.name() : supported);
+            }
+            result << generator;
+        }
     }
     return result;
 }
@@ -2206,24 +2441,28 @@ KPluginMetaData DocumentPrivate::generatorForMimeType(const QMimeType &type, QWi
     // First try to find an exact match, and then look for more general ones (e. g. the plain text one)
     // Ideally we would rank these by "closeness", but that might be overdoing it
 
-    const QVector<KPluginMetaData> available = availableGenerators();
+    const QVector<GeneratorMimeTypes> &available = generatorMimeTypes();
     QVector<KPluginMetaData> offers;
     QVector<KPluginMetaData> exactMatches;
 
-    QMimeDatabase mimeDatabase;
+    // the mimetype and all the ones it inherits from
+    QSet<QString> typeAndAncestors;
+    typeAndAncestors.insert(type.name());
+    const QStringList ancestors = type.allAncestors();
+    for (const QString &ancestor : ancestors)
+        typeAndAncestors.insert(ancestor);
 
-    for (const KPluginMetaData &md : available) {
+    for (const GeneratorMimeTypes &generator : available) {
+        const KPluginMetaData &md = generator.metaData;
         if (triedOffers.contains(md))
             continue;
 
-        const QStringList mimetypes = md.mimeTypes();
-        for (const QString &supported : mimetypes) {
-            QMimeType mimeType = mimeDatabase.mimeTypeForName(supported);
-            if (mimeType == type && !exactMatches.contains(md)) {
+        for (const QString &supported : generator.mimeTypes) {
+            if (supported == type.name() && !exactMatches.contains(md)) {
                 exactMatches << md;
             }
 
-            if (type.inherits(supported) && !offers.contains(md)) {
+            if (typeAndAncestors.contains(supported) && !offers.contains(md)) {
                 offers << md;
             }
         }
@@ -2266,6 +2505,9 @@ KPluginMetaData DocumentPrivate::generatorForMimeType(const QMimeType &type, QWi
 
 Document::OpenResult Document::openDocument(const QString &docFile, const QUrl &url, const QMimeType &_mime, const QString &password)
 {
+    QElapsedTimer openTimer;
+    openTimer.start();
+
     QMimeDatabase db;
     QMimeType mime = _mime;
     QByteArray filedata;
@@ -2335,6 +2577,7 @@ Document::OpenResult Document::openDocument(const QString &docFile, const QUrl &
         qCWarning(OkularCoreDebug).nospace() << "No plugin for mimetype '" << mime.name() << "'.";
         return OpenError;
     }
+    const qint64 generatorLookupTime = openTimer.elapsed();
 
     // 1. load Document
     OpenResult openResult = d->openDocumentInternal(offer, fromFileDescriptor, docFile, filedata, password);
@@ -2382,6 +2625,10 @@ Document::OpenResult Document::openDocument(const QString &docFile, const QUrl &
     if (openResult != OpenSuccess) {
         return openResult;
     }
+    const qint64 documentLoadTime = openTimer.elapsed() - generatorLookupTime;
+
+    // the generator may still be loading the document, see documentLoadingDone()
+    d->m_documentLoading = d->m_openAsynchronously && d->m_generator->hasFeature(Generator::AsynchronousLoading);
 
     // no need to check for the existence of a synctex file, no parser will be
     // created if none exists
@@ -2422,6 +2669,8 @@ Document::OpenResult Document::openDocument(const QString &docFile, const QUrl &
     DocumentViewport loadedViewport = (*d->m_viewportIterator);
     if (loadedViewport.isValid()) {
         (*d->m_viewportIterator) = DocumentViewport();
+        if (d->m_documentLoading)
+            d->m_loadedViewport = loadedViewport;
         if (loadedViewport.pageNumber >= (int)d->m_pagesVector.size())
             loadedViewport.pageNumber = d->m_pagesVector.size() - 1;
     } else
@@ -2442,7 +2691,9 @@ Document::OpenResult Document::openDocument(const QString &docFile, const QUrl &
     }
     d->m_memCheckTimer->start(kMemCheckTime);
 
-    const DocumentViewport nextViewport = d->nextDocumentViewport();
+    // the next viewport may not exist among the provisional pages, it is set
+    // once the document is loaded
+    const DocumentViewport nextViewport = d->m_documentLoading ? DocumentViewport() : d->nextDocumentViewport();
     if (nextViewport.isValid()) {
         setViewport(nextViewport);
         d->m_nextDocumentViewport = DocumentViewport();
@@ -2459,6 +2710,8 @@ Document::OpenResult Document::openDocument(const QString &docFile, const QUrl &
         }
     }
 
+    qCDebug(OkularCoreDebug).nospace() << "Opened " << docFile << " with " << offer.pluginId() << " in " << openTimer.elapsed() << " ms (generator lookup: " << generatorLookupTime << " ms, document loading: " << documentLoadTime << " ms)";
+
     return OpenSuccess;
 }
 
@@ -2600,7 +2853,12 @@ void Document::closeDocument()
     d->m_viewportHistory.append(DocumentViewport());
     d->m_viewportIterator = d->m_viewportHistory.begin();
     d->m_allocatedPixmapsTotalMemory = 0;
-    d->m_allocatedTextPagesFifo.clear();
+    d->m_allocatedTextPages.clear();
+    d->m_allocatedTextPagesMemory.clear();
+    d->m_allocatedTextPagesTotalMemory = 0;
+    for (QList<int> &queue : d->m_textPageQueue)
+        queue.clear();
+    d->m_queuedTextPageInProgress = -1;
     d->m_pageSize = PageSize();
     d->m_pageSizes.clear();
 
@@ -2611,6 +2869,11 @@ void Document::closeDocument()
 
     d->m_undoStack->clear();
     d->m_docdataMigrationNeeded = false;
+    d->m_documentLoading = false;
+    d->m_loadedViewport = DocumentViewport();
+
+    // all the pixmap requests of the document are gone, so the trace has all their stages
+    RenderTrace::write();
 
 #if HAVE_MALLOC_TRIM
     // trim unused memory, glibc should do this but it seems it does not
@@ -2668,7 +2931,7 @@ void Document::reparseConfig()
 {
     // reparse generator config and if something changed clear Pages
     bool configchanged = false;
-    if (d->m_generator) {
+    if (d->m_generator && !d->m_documentLoading) {
         Okular::ConfigInterface *iface = qobject_cast<Okular::ConfigInterface *>(d->m_generator);
         if (iface)
             configchanged = iface->reparseConfig();
@@ -2699,6 +2962,16 @@ bool Document::isOpened() const
     return d->m_generator;
 }
 
+void Document::setOpenAsynchronously(bool async)
+{
+    d->m_openAsynchronously = async;
+}
+
+bool Document::openAsynchronously() const
+{
+    return d->m_openAsynchronously;
+}
+
 bool Document::canConfigurePrinter() const
 {
     if (d->m_generator) {
@@ -3059,14 +3332,22 @@ static bool shouldCancelRenderingBecauseOf(const PixmapRequest &executingRequest
     if (executingRequest.height() != otherRequest.height())
         return true;
 
+    // Same priority, observer, page and size, refresh of an area of a page
+    // that is not tiled -> don't cancel, the pixmap of the page is still valid
+    const PixmapRequestPrivate *executingRequestPrivate = PixmapRequestPrivate::get(&executingRequest);
+    if (executingRequestPrivate->mForce && executingRequest.isTile() && !executingRequestPrivate->tilesManager())
+        return false;
+
     // Same priority, observer, page, different tiling -> cancel
     if (executingRequest.isTile() != otherRequest.isTile())
         return true;
 
-    // Same priority, observer, page, different tiling -> cancel
+    // Same priority, observer, page, tile no longer requested -> cancel
+    // Tiles are rendered one by one, so a tile is only worth cancelling
+    // if the new request does not need it anymore
     if (executingRequest.isTile()) {
-        const NormalizedRect bothRequestsRect = executingRequest.normalizedRect() | otherRequest.normalizedRect();
-        if (!(bothRequestsRect == executingRequest.normalizedRect()))
+        const NormalizedRect executingRect = TilesManager::toRotatedRect(executingRequest.normalizedRect(), executingRequest.page()->rotation());
+        if (!executingRect.intersects(otherRequest.normalizedRect()))
             return true;
     }
 
@@ -3113,7 +3394,9 @@ void Document::requestPixmaps(const QLinkedList<PixmapRequest *> &requests, Pixm
     if (requests.isEmpty())
         return;
 
-    if (!d->m_pageController) {
+    // the pages of a document that is still loading are provisional, the
+    // observers request the pixmaps of the loaded pages again
+    if (!d->m_pageController || d->m_documentLoading) {
         // delete requests..
         QLinkedList<PixmapRequest *>::const_iterator rIt = requests.constBegin(), rEnd = requests.constEnd();
         for (; rIt != rEnd; ++rIt)
@@ -3158,7 +3441,7 @@ void Document::requestPixmaps(const QLinkedList<PixmapRequest *> &requests, Pixm
 
         request->d->mPage = d->m_pagesVector.value(request->pageNumber());
 
-        if (request->isTile()) {
+        if (request->isTile() && request->d->tilesManager()) {
             // Change the current request rect so that only invalid tiles are
             // requested. Also make sure the rect is tile-aligned.
             NormalizedRect tilesRect;
@@ -3211,6 +3494,7 @@ void Document::requestPixmaps(const QLinkedList<PixmapRequest *> &requests, Pixm
 
     // 2. [ADD TO STACK] add requests to stack
     for (PixmapRequest *request : requests) {
+        request->d->mQueuedTime = RenderTrace::now();
         // add request to the 'stack' at the right place
         if (!request->priority())
             // add priority zero requests to the top of the stack
@@ -3237,19 +3521,110 @@ void Document::requestPixmaps(const QLinkedList<PixmapRequest *> &requests, Pixm
         o->notifyContentsCleared(Okular::DocumentObserver::Pixmap);
 }
 
+void Document::supersedePixmapRequests(DocumentObserver *observer)
+{
+    QSet<DocumentObserver *> observersPixmapCleared;
+
+    d->m_pixmapRequestsMutex.lock();
+    QLinkedList<PixmapRequest *>::iterator sIt = d->m_pixmapRequestsStack.begin(), sEnd = d->m_pixmapRequestsStack.end();
+    while (sIt != sEnd) {
+        if ((*sIt)->observer() == observer) {
+            delete *sIt;
+            sIt = d->m_pixmapRequestsStack.erase(sIt);
+        } else
+            ++sIt;
+    }
+
+    // unlike cancelRenderingBecauseOf(), keep the current pixmaps of the pages,
+    // unless they were partially painted by the aborted requests
+    if (d->m_generator && d->m_generator->hasFeature(Generator::SupportsCancelling)) {
+        for (PixmapRequest *executingRequest : qAsConst(d->m_executingPixmapRequests)) {
+            if (executingRequest->observer() != observer || !executingRequest->d->mResultImage.isNull() || executingRequest->d->mShouldAbortRender != 0)
+                continue;
+
+            if (executingRequest->partialUpdatesWanted()) {
+                d->cancelRenderingBecauseOf(executingRequest, nullptr);
+                observersPixmapCleared << observer;
+                continue;
+            }
+
+            TilesManager *tm = executingRequest->d->tilesManager();
+            if (tm)
+                tm->setRequest(NormalizedRect(), 0, 0);
+            executingRequest->d->mShouldAbortRender = 1;
+        }
+    }
+    d->m_pixmapRequestsMutex.unlock();
+
+    for (DocumentObserver *o : qAsConst(observersPixmapCleared))
+        o->notifyContentsCleared(Okular::DocumentObserver::Pixmap);
+}
+
 void Document::requestTextPage(uint pageNumber)
 {
     Page *kp = d->m_pagesVector[pageNumber];
-    if (!d->m_generator || !kp)
+    if (!d->m_generator || !kp || d->m_documentLoading)
         return;
 
+    // it's generated now, so it doesn't need to be queued anymore
+    for (QList<int> &queue : d->m_textPageQueue)
+        queue.removeAll(pageNumber);
+
+    // if it's being generated in the background, wait for it instead of
+    // generating it twice
+    GeneratorPrivate *generatorPrivate = d->m_generator->d_ptr;
+    TextPageGenerationThread *thread = generatorPrivate->mTextPageGenerationThread;
+    if (thread && thread->page() == kp && thread->isRunning()) {
+        thread->wait();
+        // the queued notification of the end of the thread still does the
+        // bookkeeping, it just finds no text page left to set
+        if (TextPage *tp = thread->takeTextPage()) {
+            kp->setTextPage(tp);
+            d->textGenerationDone(kp);
+            return;
+        }
+    }
+
     // Memory management for TextPages
 
     d->m_generator->generateTextPage(kp);
 }
 
+void Document::queueTextPage(uint pageNumber, TextPagePriority priority)
+{
+    // the queue is only processed in a thread
+    if (!d->m_generator || !d->m_generator->hasFeature(Generator::TextExtraction) || !d->m_generator->hasFeature(Generator::Threaded) || d->m_documentLoading || (int)pageNumber >= d->m_pagesVector.count())
+        return;
+
+    const TextPageGenerationThread *thread = d->m_generator->d_ptr->mTextPageGenerationThread;
+    Page *kp = d->m_pagesVector[pageNumber];
+    if (kp->hasTextPage() || (int)pageNumber == d->m_queuedTextPageInProgress || (thread && thread->page() == kp))
+        return;
+
+    // a page is queued once, with the highest priority it was queued with
+    for (int p = 0; p < d->m_textPageQueue.count(); ++p) {
+        if (d->m_textPageQueue[p].contains(pageNumber)) {
+            if (p <= priority)
+                return;
+            d->m_textPageQueue[p].removeAll(pageNumber);
+        }
+    }
+    d->m_textPageQueue[priority].append(pageNumber);
+
+    d->processTextPageQueue();
+}
+
+void Document::cancelTextPageRequests(TextPagePriority priority)
+{
+    d->m_textPageQueue[priority].clear();
+}
+
 void DocumentPrivate::notifyAnnotationChanges(int page)
 {
+    // the annotations may have been modified in place
+    if (Page *kp = m_pagesVector.value(page))
+        kp->d->annotationsChanged();
+
     foreachObserverD(notifyPageChanged(page, DocumentObserver::Annotations));
 }
 
@@ -3714,6 +4089,7 @@ void Document::resetSearch(int searchID)
 void Document::cancelSearch()
 {
     d->m_searchCancelled = true;
+    cancelTextPageRequests(SearchTextPage);
 }
 
 void Document::undo()
@@ -4052,7 +4428,7 @@ void Document::processFormatAction(const Action *action, Okular::FormFieldText *
         fft->setText(formattedText);
         fft->setAppearanceText(formattedText);
         emit refreshFormWidget(fft);
-        d->refreshPixmaps(foundPage);
+        d->refreshPixmaps(foundPage, fft->rect());
         // Then we make the form have the unformatted text, to use
         // in calculations and other things.
         fft->setText(unformattedText);
@@ -4062,7 +4438,7 @@ void Document::processFormatAction(const Action *action, Okular::FormFieldText *
         // This is because the recalculateForms function delegated
         // the responsiblity for the refresh to us.
         emit refreshFormWidget(fft);
-        d->refreshPixmaps(foundPage);
+        d->refreshPixmaps(foundPage, fft->rect());
     }
 }
 
@@ -4971,6 +5347,11 @@ void DocumentPrivate::requestDone(PixmapRequest *req)
         else
             qCWarning(OkularCoreDebug) << "Receiving a done request for the defunct observer" << observer;
 #endif
+
+        if (RenderTrace::isEnabled() && req->d->mSentTime >= 0) {
+            RenderTrace::recordRenderTime(m_generatorName, RenderTrace::now() - req->d->mSentTime);
+            RenderTrace::recordMemory(m_allocatedPixmapsTotalMemory, m_allocatedTextPagesTotalMemory);
+        }
     }
 
     // 3. delete request
@@ -5033,17 +5414,219 @@ void DocumentPrivate::textGenerationDone(Page *page)
     if (!m_pageController)
         return;
 
-    // 1. If we reached the cache limit, delete the first text page from the fifo
-    if (m_allocatedTextPagesFifo.size() == m_maxAllocatedTextPages) {
-        int pageToKick = m_allocatedTextPagesFifo.takeFirst();
-        if (pageToKick != page->number()) // this should never happen but better be safe than sorry
-        {
-            m_pagesVector.at(pageToKick)->setTextPage(nullptr); // deletes the textpage
+    const int pageNumber = page->number();
+
+    // 1. Forget the text page this one replaces, if any
+    if (m_allocatedTextPagesMemory.contains(pageNumber)) {
+        m_allocatedTextPagesTotalMemory -= m_allocatedTextPagesMemory.take(pageNumber);
+        m_allocatedTextPages.removeOne(pageNumber);
+    }
+
+    // 2. If we reached the cache limit, delete the least recently used text page
+    cleanupTextPages(m_maxAllocatedTextPages - 1);
+
+    // 3. Add the page to the most recently used text pages
+    const qulonglong memory = page->d->textPageMemoryUsage();
+    m_allocatedTextPages.append(pageNumber);
+    m_allocatedTextPagesMemory.insert(pageNumber, memory);
+    m_allocatedTextPagesTotalMemory += memory;
+}
+
+bool DocumentPrivate::isTextPageInUse(int pageNumber) const
+{
+    // the visible pages are in use
+    for (const VisiblePageRect *rect : m_pageRects) {
+        if (rect->pageNumber == pageNumber)
+            return true;
+    }
+
+    // and so are the pages the searches continue from, as the text page
+    // remembers where the last match is
+    for (const RunningSearch *search : m_searches) {
+        if (search->continueOnPage == pageNumber)
+            return true;
+    }
+
+    return false;
+}
+
+void DocumentPrivate::touchTextPage(int pageNumber)
+{
+    if (m_allocatedTextPages.isEmpty() || m_allocatedTextPages.last() == pageNumber)
+        return;
+
+    if (m_allocatedTextPages.removeOne(pageNumber))
+        m_allocatedTextPages.append(pageNumber);
+}
+
+void DocumentPrivate::unloadTextPage(int pageNumber)
+{
+    qCDebug(OkularCoreDebug).nospace() << "Evicting cache text page=" << pageNumber;
+
+    m_allocatedTextPages.removeOne(pageNumber);
+    m_allocatedTextPagesTotalMemory -= m_allocatedTextPagesMemory.take(pageNumber);
+    if (pageNumber < m_pagesVector.count())
+        m_pagesVector.at(pageNumber)->setTextPage(nullptr); // deletes the textpage
+}
+
+void DocumentPrivate::cleanupTextPages(int maxTextPages)
+{
+    // Delete the least recently used text pages that are not in use
+    const QList<int> textPages = m_allocatedTextPages;
+    for (int pageNumber : textPages) {
+        if (m_allocatedTextPages.count() <= maxTextPages)
+            break;
+        if (!isTextPageInUse(pageNumber))
+            unloadTextPage(pageNumber);
+    }
+}
+
+qulonglong DocumentPrivate::cleanupTextPageMemory(qulonglong memoryToFree, int minDistance)
+{
+    if (memoryToFree < 1)
+        return 0;
+
+    // Free memory starting from the text pages that are farthest from the
+    // current one, the least recently used first among equally far pages
+    const int currentViewportPage = (*m_viewportIterator).pageNumber;
+    QList<int> candidates;
+    for (int pageNumber : qAsConst(m_allocatedTextPages)) {
+        if (qAbs(pageNumber - currentViewportPage) >= minDistance && !isTextPageInUse(pageNumber))
+            candidates.append(pageNumber);
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [currentViewportPage](int a, int b) { return qAbs(a - currentViewportPage) > qAbs(b - currentViewportPage); });
+
+    for (int pageNumber : qAsConst(candidates)) {
+        if (memoryToFree < 1)
+            break;
+
+        const qulonglong memory = m_allocatedTextPagesMemory.value(pageNumber);
+        unloadTextPage(pageNumber);
+        memoryToFree = (memory < memoryToFree) ? (memoryToFree - memory) : 0;
+    }
+
+    return memoryToFree;
+}
+
+void DocumentPrivate::documentLoadingDone(const QVector<Page *> &pagesVector)
+{
+    if (!m_documentLoading) {
+        qDeleteAll(pagesVector);
+        return;
+    }
+    m_documentLoading = false;
+
+    // the document is closed by who opened it, as for a failed openDocument()
+    if (pagesVector.isEmpty()) {
+        emit m_parent->documentLoadingFailed();
+        return;
+    }
+
+    // remove the requests for the provisional pages
+    clearAndWaitForRequests();
+    qDeleteAll(m_allocatedPixmaps);
+    m_allocatedPixmaps.clear();
+    m_allocatedPixmapsTotalMemory = 0;
+    m_allocatedTextPages.clear();
+    m_allocatedTextPagesMemory.clear();
+    m_allocatedTextPagesTotalMemory = 0;
+    qDeleteAll(m_searches);
+    m_searches.clear();
+
+    // forget what was asked to the generator while it was loading
+    m_documentInfo = DocumentInfo();
+    m_documentInfoAskedKeys.clear();
+    m_exportCached = false;
+    m_exportFormats.clear();
+    m_exportToText = ExportFormat();
+    m_fontsCached = false;
+    m_fontsCache.clear();
+    m_pageSizes.clear();
+
+    // replace the provisional pages, and restore the saved data of the pages
+    qDeleteAll(m_pagesVector);
+    m_pagesVector = pagesVector;
+    for (Page *p : qAsConst(m_pagesVector)) {
+        p->d->m_doc = this;
+        if (m_rotation != Rotation0)
+            p->d->rotateAt(m_rotation);
+    }
+
+    m_metadataLoadingCompleted = false;
+    if (m_archiveData)
+        loadDocumentInfo(m_archiveData->metadataFile, LoadPageInfo);
+    else
+        loadDocumentInfo(LoadPageInfo);
+    m_metadataLoadingCompleted = true;
+
+    foreachObserverD(notifySetup(m_pagesVector, DocumentObserver::DocumentChanged));
+
+    // go to the restored or the requested viewport, now that its page exists
+    DocumentViewport viewport = m_loadedViewport.isValid() ? m_loadedViewport : (*m_viewportIterator);
+    m_loadedViewport = DocumentViewport();
+    const DocumentViewport nextViewport = nextDocumentViewport();
+    if (nextViewport.isValid()) {
+        viewport = nextViewport;
+        m_nextDocumentViewport = DocumentViewport();
+        m_nextDocumentDestination = QString();
+    }
+    if (viewport.pageNumber >= (int)m_pagesVector.size())
+        viewport.pageNumber = m_pagesVector.size() - 1;
+    m_parent->setViewport(viewport);
+
+    qCDebug(OkularCoreDebug).nospace() << "Loaded " << m_docFileName << " asynchronously, " << m_pagesVector.count() << " pages";
+}
+
+void DocumentPrivate::textPageThreadFinished(Page *page)
+{
+    if (page && (int)page->number() == m_queuedTextPageInProgress)
+        m_queuedTextPageInProgress = -1;
+
+    processTextPageQueue();
+}
+
+void DocumentPrivate::processTextPageQueue()
+{
+    if (!m_generator || m_queuedTextPageInProgress != -1 || !m_generator->canGenerateTextPage())
+        return;
+
+    // take the first page of the queue with the highest priority
+    Page *page = nullptr;
+    for (int priority = 0; priority < m_textPageQueue.count() && !page; ++priority) {
+        QList<int> &queue = m_textPageQueue[priority];
+        while (!queue.isEmpty() && !page) {
+            const int pageNumber = queue.takeFirst();
+            if (pageNumber < m_pagesVector.count() && !m_pagesVector[pageNumber]->hasTextPage()) {
+                page = m_pagesVector[pageNumber];
+                m_queuedTextPageInProgressPriority = (Document::TextPagePriority)priority;
+            }
         }
     }
+    if (!page)
+        return;
 
-    // 2. Add the page to the fifo of generated text pages
-    m_allocatedTextPagesFifo.append(page->number());
+    GeneratorPrivate *generatorPrivate = m_generator->d_ptr;
+    {
+        QMutexLocker locker(generatorPrivate->threadsLock());
+        if (generatorPrivate->m_closing)
+            return;
+        generatorPrivate->mTextPageReady = false;
+    }
+    m_queuedTextPageInProgress = page->number();
+    generatorPrivate->textPageGenerationThread()->setPage(page);
+    generatorPrivate->textPageGenerationThread()->startGeneration();
+}
+
+void DocumentPrivate::queueSearchTextPages(int pageNumber, bool forward)
+{
+    // get the text of the next pages in the background while the current
+    // one is searched
+    const int pageCount = m_pagesVector.count();
+    for (int i = 1; i <= 2; ++i) {
+        const int nextPage = forward ? pageNumber + i : pageNumber - i;
+        if (nextPage >= 0 && nextPage < pageCount)
+            m_parent->queueTextPage(nextPage, Document::SearchTextPage);
+    }
 }
 
 void Document::setRotation(int r)
@@ -218,6 +218,27 @@ public:
      */
     OpenResult openDocument(const QString &docFile, const QUrl &url, const QMimeType &mime, const QString &password = QString());
 
+    /**
+     * Sets whether the documents are opened asynchronously by the generators
+     * that can (see Generator::AsynchronousLoading).
+     *
+     * openDocument() then returns as soon as the generator provides
+     * provisional pages, and the observers get the pages of the loaded
+     * document with DocumentObserver::notifySetup() once it is loaded.
+     *
+     * Documents are opened synchronously by default.
+     *
+     * @since 1.11
+     */
+    void setOpenAsynchronously(bool async);
+
+    /**
+     * Returns whether the documents are opened asynchronously.
+     *
+     * @since 1.11
+     */
+    bool openAsynchronously() const;
+
     /**
      * Closes the document.
      */
@@ -486,11 +507,58 @@ public:
      */
     void requestPixmaps(const QLinkedList<PixmapRequest *> &requests, PixmapRequestFlags reqOptions);
 
+    /**
+     * Discards the pending pixmap requests of the given @p observer, for example
+     * because its zoom level changed and they are stale.
+     *
+     * The requests being rendered are aborted if the generator supports
+     * cancelling, otherwise they are left to finish. The pixmaps of the pages are
+     * kept, so that they can be painted scaled until the new requests are done.
+     *
+     * @since 1.11
+     */
+    void supersedePixmapRequests(DocumentObserver *observer);
+
     /**
      * Sends a request for text page generation for the given page @p pageNumber.
+     *
+     * The text page is generated right away. If it is already being
+     * generated in the background, that generation is waited for instead.
      */
     void requestTextPage(uint pageNumber);
 
+    /**
+     * The priorities of the text pages queued with queueTextPage(), from the
+     * highest to the lowest.
+     *
+     * @since 1.11
+     */
+    enum TextPagePriority {
+        InteractiveTextPage, ///< The text is needed soon by the user, e.g. for selecting text in a visible page
+        SearchTextPage,      ///< The text is needed by a running search
+        BackgroundTextPage   ///< The text is not needed yet, e.g. for indexing the document
+    };
+
+    /**
+     * Queues the generation of the text page of page @p pageNumber with the
+     * given @p priority.
+     *
+     * The queued text pages are generated in a thread one after the other,
+     * the ones with higher priority first. A page that is already queued
+     * keeps the higher of the two priorities. Nothing is done for generators
+     * that are not Generator::Threaded.
+     *
+     * @since 1.11
+     */
+    void queueTextPage(uint pageNumber, TextPagePriority priority);
+
+    /**
+     * Removes the queued text pages with the given @p priority.
+     *
+     * @since 1.11
+     */
+    void cancelTextPageRequests(TextPagePriority priority);
+
     /**
      * Adds a new @p annotation to the given @p page.
      */
@@ -1244,6 +1312,16 @@ Q_SIGNALS:
      */
     void refreshFormWidget(Okular::FormField *field);
 
+    /**
+     * This signal is emitted when a document opened asynchronously could not
+     * be loaded after all. The document is left open with its provisional
+     * pages, it is up to the receiver to close it.
+     *
+     * @see setOpenAsynchronously()
+     * @since 1.11
+     */
+    void documentLoadingFailed();
+
 private:
     /// @cond PRIVATE
     friend class DocumentPrivate;
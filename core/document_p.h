@@ -113,7 +113,11 @@ public:
         , m_tempFile(nullptr)
         , m_docSize(-1)
         , m_allocatedPixmapsTotalMemory(0)
+        , m_allocatedTextPagesTotalMemory(0)
         , m_maxAllocatedTextPages(0)
+        , m_textPageQueue(3)
+        , m_queuedTextPageInProgress(-1)
+        , m_queuedTextPageInProgressPriority(Document::BackgroundTextPage)
         , m_warnedOutOfMemory(false)
         , m_rotation(Rotation0)
         , m_exportCached(false)
@@ -131,6 +135,8 @@ public:
         , m_annotationEditingEnabled(true)
         , m_annotationBeingModified(false)
         , m_docdataMigrationNeeded(false)
+        , m_openAsynchronously(false)
+        , m_documentLoading(false)
         , m_synctex_scanner(nullptr)
     {
         calculateMaxTextPages();
@@ -143,9 +149,15 @@ public:
     QString localizedSize(const QSizeF size) const;
     qulonglong calculateMemoryToFree();
     void cleanupPixmapMemory();
-    void cleanupPixmapMemory(qulonglong memoryToFree);
+    void cleanupMemory(qulonglong memoryToFree);
+    qulonglong cleanupPixmapMemory(qulonglong memoryToFree);
     AllocatedPixmap *searchLowestPriorityPixmap(bool unloadableOnly = false, bool thenRemoveIt = false, DocumentObserver *observer = nullptr /* any */);
     void calculateMaxTextPages();
+    qulonglong cleanupTextPageMemory(qulonglong memoryToFree, int minDistance = 0);
+    void cleanupTextPages(int maxTextPages);
+    bool isTextPageInUse(int pageNumber) const;
+    void touchTextPage(int pageNumber);
+    void unloadTextPage(int pageNumber);
     qulonglong getTotalMemory();
     qulonglong getFreeMemory(qulonglong *freeSwap = nullptr);
     bool loadDocumentInfo(LoadDocumentInfoFlags loadWhat);
@@ -173,11 +185,15 @@ public:
     bool canRemoveExternalAnnotations() const;
     OKULARCORE_EXPORT static QString docDataFileName(const QUrl &url, qint64 document_size);
     bool cancelRenderingBecauseOf(PixmapRequest *executingRequest, PixmapRequest *newRequest);
+    // Narrows a tiled request to its central tile and queues the other tiles
+    // as separate requests. m_pixmapRequestsMutex must be locked.
+    void splitTiledPixmapRequest(PixmapRequest *request);
 
     // Methods that implement functionality needed by undo commands
     void performAddPageAnnotation(int page, Annotation *annotation);
     void performRemovePageAnnotation(int page, Annotation *annotation);
-    void performModifyPageAnnotation(int page, Annotation *annotation, bool appearanceChanged);
+    // oldBoundingRect is the bounding rect of the annotation before the modification, if known
+    void performModifyPageAnnotation(int page, Annotation *annotation, bool appearanceChanged, const NormalizedRect &oldBoundingRect = NormalizedRect());
     void performSetAnnotationContents(const QString &newContents, Annotation *annot, int pageNumber);
 
     void recalculateForms();
@@ -190,7 +206,9 @@ public:
     void slotFontReadingProgress(int page);
     void fontReadingGotFont(const Okular::FontInfo &font);
     void slotGeneratorConfigChanged();
-    void refreshPixmaps(int);
+    // Renders the pixmaps of the page again; if dirtyRect (in page
+    // coordinates) is not null, only the area around it is rendered
+    void refreshPixmaps(int pageNumber, const NormalizedRect &dirtyRect = NormalizedRect());
     void _o_configChanged();
     void doContinueDirectionMatchSearch(void *doContinueDirectionMatchSearchStruct);
     void doContinueAllDocumentSearch(void *pagesToNotifySet, void *pageMatchesMap, int currentPage, int searchID);
@@ -212,6 +230,14 @@ public:
      */
     void requestDone(PixmapRequest *request);
     void textGenerationDone(Page *page);
+    // called when the text page generation thread finished with @p page
+    void textPageThreadFinished(Page *page);
+    // starts the generation of the next queued text page, if the generator is free
+    void processTextPageQueue();
+    // queues the text pages of the pages a search goes to after @p pageNumber
+    void queueSearchTextPages(int pageNumber, bool forward);
+    // called when a generator finished loading the document asynchronously
+    void documentLoadingDone(const QVector<Page *> &pagesVector);
     /**
      * Sets the bounding box of the given @p page (in terms of upright orientation, i.e., Rotation0).
      */
@@ -275,8 +301,17 @@ public:
     QMutex m_pixmapRequestsMutex;
     QLinkedList<AllocatedPixmap *> m_allocatedPixmaps;
     qulonglong m_allocatedPixmapsTotalMemory;
-    QList<int> m_allocatedTextPagesFifo;
+    // the pages with a text page, the least recently used first, and the
+    // memory used by their text pages
+    QList<int> m_allocatedTextPages;
+    QHash<int, qulonglong> m_allocatedTextPagesMemory;
+    qulonglong m_allocatedTextPagesTotalMemory;
     int m_maxAllocatedTextPages;
+    // the text pages queued with Document::queueTextPage, one list for
+    // each Document::TextPagePriority, and the one being generated
+    QVector<QList<int>> m_textPageQueue;
+    int m_queuedTextPageInProgress;
+    Document::TextPagePriority m_queuedTextPageInProgressPriority;
     bool m_warnedOutOfMemory;
 
     // the rotation applied to the document
@@ -340,6 +375,12 @@ public:
     // for the current document contains any annotation or form.
     bool m_docdataMigrationNeeded;
 
+    // whether the documents are opened asynchronously, whether the current
+    // one is still loading, and the viewport to go to once it is loaded
+    bool m_openAsynchronously;
+    bool m_documentLoading;
+    DocumentViewport m_loadedViewport;
+
     synctex_scanner_p m_synctex_scanner;
 
     QString m_openError;
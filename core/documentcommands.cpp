@@ -159,15 +159,17 @@ ModifyAnnotationPropertiesCommand::ModifyAnnotationPropertiesCommand(DocumentPri
 void ModifyAnnotationPropertiesCommand::undo()
 {
     moveViewportIfBoundingRectNotFullyVisible(m_annotation->boundingRectangle(), m_docPriv, m_pageNumber);
+    const NormalizedRect oldBoundingRect = m_annotation->boundingRectangle();
     m_annotation->setAnnotationProperties(m_prevProperties);
-    m_docPriv->performModifyPageAnnotation(m_pageNumber, m_annotation, true);
+    m_docPriv->performModifyPageAnnotation(m_pageNumber, m_annotation, true, oldBoundingRect);
 }
 
 void ModifyAnnotationPropertiesCommand::redo()
 {
     moveViewportIfBoundingRectNotFullyVisible(m_annotation->boundingRectangle(), m_docPriv, m_pageNumber);
+    const NormalizedRect oldBoundingRect = m_annotation->boundingRectangle();
     m_annotation->setAnnotationProperties(m_newProperties);
-    m_docPriv->performModifyPageAnnotation(m_pageNumber, m_annotation, true);
+    m_docPriv->performModifyPageAnnotation(m_pageNumber, m_annotation, true, oldBoundingRect);
 }
 
 bool ModifyAnnotationPropertiesCommand::refreshInternalPageReferences(const QVector<Okular::Page *> &newPagesVector)
@@ -193,15 +195,17 @@ TranslateAnnotationCommand::TranslateAnnotationCommand(DocumentPrivate *docPriv,
 void TranslateAnnotationCommand::undo()
 {
     moveViewportIfBoundingRectNotFullyVisible(translateBoundingRectangle(minusDelta()), m_docPriv, m_pageNumber);
+    const NormalizedRect oldBoundingRect = m_annotation->boundingRectangle();
     m_annotation->translate(minusDelta());
-    m_docPriv->performModifyPageAnnotation(m_pageNumber, m_annotation, true);
+    m_docPriv->performModifyPageAnnotation(m_pageNumber, m_annotation, true, oldBoundingRect);
 }
 
 void TranslateAnnotationCommand::redo()
 {
     moveViewportIfBoundingRectNotFullyVisible(translateBoundingRectangle(m_delta), m_docPriv, m_pageNumber);
+    const NormalizedRect oldBoundingRect = m_annotation->boundingRectangle();
     m_annotation->translate(m_delta);
-    m_docPriv->performModifyPageAnnotation(m_pageNumber, m_annotation, true);
+    m_docPriv->performModifyPageAnnotation(m_pageNumber, m_annotation, true, oldBoundingRect);
 }
 
 int TranslateAnnotationCommand::id() const
@@ -266,15 +270,17 @@ void AdjustAnnotationCommand::undo()
     const NormalizedPoint minusDelta1 = Okular::NormalizedPoint(-m_delta1.x, -m_delta1.y);
     const NormalizedPoint minusDelta2 = Okular::NormalizedPoint(-m_delta2.x, -m_delta2.y);
     moveViewportIfBoundingRectNotFullyVisible(adjustBoundingRectangle(minusDelta1, minusDelta2), m_docPriv, m_pageNumber);
+    const NormalizedRect oldBoundingRect = m_annotation->boundingRectangle();
     m_annotation->adjust(minusDelta1, minusDelta2);
-    m_docPriv->performModifyPageAnnotation(m_pageNumber, m_annotation, true);
+    m_docPriv->performModifyPageAnnotation(m_pageNumber, m_annotation, true, oldBoundingRect);
 }
 
 void AdjustAnnotationCommand::redo()
 {
     moveViewportIfBoundingRectNotFullyVisible(adjustBoundingRectangle(m_delta1, m_delta2), m_docPriv, m_pageNumber);
+    const NormalizedRect oldBoundingRect = m_annotation->boundingRectangle();
     m_annotation->adjust(m_delta1, m_delta2);
-    m_docPriv->performModifyPageAnnotation(m_pageNumber, m_annotation, true);
+    m_docPriv->performModifyPageAnnotation(m_pageNumber, m_annotation, true, oldBoundingRect);
 }
 
 int AdjustAnnotationCommand::id() const
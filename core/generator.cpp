@@ -31,6 +31,7 @@
 #include "document_p.h"
 #include "page.h"
 #include "page_p.h"
+#include "rendertrace_p.h"
 #include "textpage.h"
 #include "utils.h"
 
@@ -108,7 +109,7 @@ void GeneratorPrivate::pixmapGenerationFinished()
     }
 
     if (!request->shouldAbortRender()) {
-        request->page()->setPixmap(request->observer(), new QPixmap(QPixmap::fromImage(img)), request->normalizedRect());
+        request->page()->setPixmap(request->observer(), new QPixmap(QPixmap::fromImage(img)), request->isTile() ? request->normalizedRect() : NormalizedRect());
         const int pageNumber = request->page()->number();
 
         if (mPixmapGenerationThread->calcBoundingBox())
@@ -148,6 +149,9 @@ void GeneratorPrivate::textpageGenerationFinished()
         page->setTextPage(tp);
         q->signalTextGenerationDone(page, tp);
     }
+
+    if (m_document)
+        m_document->textPageThreadFinished(page);
 }
 
 QMutex *GeneratorPrivate::threadsLock()
@@ -284,7 +288,7 @@ void Generator::generatePixmap(PixmapRequest *request)
     }
 
     const QImage &img = image(request);
-    request->page()->setPixmap(request->observer(), new QPixmap(QPixmap::fromImage(img)), request->normalizedRect());
+    request->page()->setPixmap(request->observer(), new QPixmap(QPixmap::fromImage(img)), request->isTile() ? request->normalizedRect() : NormalizedRect());
     const int pageNumber = request->page()->number();
 
     d->mPixmapReady = true;
@@ -410,6 +414,9 @@ bool Generator::hasFeature(GeneratorFeature feature) const
 void Generator::signalPixmapRequestDone(PixmapRequest *request)
 {
     Q_D(Generator);
+    PixmapRequestPrivate *requestPrivate = PixmapRequestPrivate::get(request);
+    if (requestPrivate->mSentTime >= 0)
+        requestPrivate->mDoneTime = RenderTrace::now();
     if (d->m_document)
         d->m_document->requestDone(request);
     else {
@@ -426,13 +433,22 @@ void Generator::signalTextGenerationDone(Page *page, TextPage *textPage)
         delete textPage;
 }
 
+void Generator::signalDocumentLoadingDone(const QVector<Page *> &pagesVector)
+{
+    Q_D(Generator);
+    if (d->m_document)
+        d->m_document->documentLoadingDone(pagesVector);
+    else
+        qDeleteAll(pagesVector);
+}
+
 void Generator::signalPartialPixmapRequest(PixmapRequest *request, const QImage &image)
 {
     if (request->shouldAbortRender())
         return;
 
     PagePrivate *pagePrivate = PagePrivate::get(request->page());
-    pagePrivate->setPixmap(request->observer(), new QPixmap(QPixmap::fromImage(image)), request->normalizedRect(), true /* isPartialPixmap */);
+    pagePrivate->setPixmap(request->observer(), new QPixmap(QPixmap::fromImage(image)), request->isTile() ? request->normalizedRect() : NormalizedRect(), true /* isPartialPixmap */);
 
     const int pageNumber = request->page()->number();
     request->observer()->notifyPageChanged(pageNumber, Okular::DocumentObserver::Pixmap);
@@ -565,10 +581,18 @@ PixmapRequest::PixmapRequest(DocumentObserver *observer, int pageNumber, int wid
     d->mNormalizedRect = NormalizedRect();
     d->mPartialUpdatesWanted = false;
     d->mShouldAbortRender = 0;
+    d->mRequestedTime = RenderTrace::now();
+    d->mQueuedTime = -1;
+    d->mSentTime = -1;
+    d->mGenerationStartTime = -1;
+    d->mGenerationEndTime = -1;
+    d->mDoneTime = -1;
 }
 
 PixmapRequest::~PixmapRequest()
 {
+    if (d->mRequestedTime >= 0)
+        RenderTrace::recordPixmapRequest(d);
     delete d;
 }
 
@@ -13,6 +13,7 @@
 
 #include "fontinfo.h"
 #include "generator.h"
+#include "rendertrace_p.h"
 #include "utils.h"
 
 using namespace Okular;
@@ -60,10 +61,13 @@ NormalizedRect PixmapGenerationThread::boundingBox() const
 void PixmapGenerationThread::run()
 {
     if (mRequest) {
-        PixmapRequestPrivate::get(mRequest)->mResultImage = mGenerator->image(mRequest);
+        PixmapRequestPrivate *requestPrivate = PixmapRequestPrivate::get(mRequest);
+        requestPrivate->mGenerationStartTime = RenderTrace::now();
+        requestPrivate->mResultImage = mGenerator->image(mRequest);
 
         if (mCalcBoundingBox)
-            mBoundingBox = Utils::imageBoundingBox(&PixmapRequestPrivate::get(mRequest)->mResultImage);
+            mBoundingBox = Utils::imageBoundingBox(&requestPrivate->mResultImage);
+        requestPrivate->mGenerationEndTime = RenderTrace::now();
     }
 }
 
@@ -107,6 +111,13 @@ TextPage *TextPageGenerationThread::textPage() const
     return mTextPage;
 }
 
+TextPage *TextPageGenerationThread::takeTextPage()
+{
+    TextPage *textPage = mTextPage;
+    mTextPage = nullptr;
+    return textPage;
+}
+
 void TextPageGenerationThread::abortExtraction()
 {
     // If extraction already finished no point in aborting
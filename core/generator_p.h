@@ -95,6 +95,14 @@ public:
     NormalizedRect mNormalizedRect;
     QAtomicInt mShouldAbortRender;
     QImage mResultImage;
+
+    // stages of the request in the render trace, -1 when not reached or not tracing
+    qint64 mRequestedTime;
+    qint64 mQueuedTime;
+    qint64 mSentTime;
+    qint64 mGenerationStartTime;
+    qint64 mGenerationEndTime;
+    qint64 mDoneTime;
 };
 
 class TextRequestPrivate
@@ -146,6 +154,8 @@ public:
     Page *page() const;
 
     TextPage *textPage() const;
+    // gives the ownership of the generated text page to the caller
+    TextPage *takeTextPage();
 
     void abortExtraction();
     bool shouldAbortExtraction() const;
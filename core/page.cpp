@@ -14,9 +14,11 @@
 #include "page_p.h"
 
 // qt/kde includes
+#include <QAtomicInt>
 #include <QDomDocument>
 #include <QDomElement>
 #include <QHash>
+#include <QPainter>
 #include <QPixmap>
 #include <QSet>
 #include <QString>
@@ -90,6 +92,8 @@ PagePrivate::PagePrivate(Page *page, uint n, double w, double h, Rotation o)
 
     if (m_height <= 0)
         m_height = 1;
+
+    annotationsChanged();
 }
 
 PagePrivate::~PagePrivate()
@@ -519,6 +523,13 @@ QLinkedList<FormField *> Page::formFields() const
     return d->formfields;
 }
 
+void PagePrivate::annotationsChanged()
+{
+    // pages may be created in a thread loading the document
+    static QAtomicInt lastAnnotationsRevision;
+    m_annotationsRevision = lastAnnotationsRevision.fetchAndAddRelaxed(1) + 1;
+}
+
 void Page::setPixmap(DocumentObserver *observer, QPixmap *pixmap, const NormalizedRect &rect)
 {
     d->setPixmap(observer, pixmap, rect, false /*isPartialPixmap*/);
@@ -535,6 +546,24 @@ void PagePrivate::setPixmap(DocumentObserver *observer, QPixmap *pixmap, const N
         }
 
         QMap<DocumentObserver *, PagePrivate::PixmapObject>::iterator it = m_pixmaps.find(observer);
+        if (!rect.isNull()) {
+            // a rerendered area of the current pixmap, draw it over it
+            QPixmap *currentPixmap = it != m_pixmaps.end() ? it.value().m_pixmap : nullptr;
+            if (!currentPixmap || rect.geometry(currentPixmap->width(), currentPixmap->height()).size() != pixmap->size()) {
+                // the area was rendered for another size of the page, it
+                // must not replace the pixmap of the whole page
+                delete pixmap;
+                return;
+            }
+            if (pixmap->size() != currentPixmap->size()) {
+                QPainter p(currentPixmap);
+                p.drawPixmap(rect.geometry(currentPixmap->width(), currentPixmap->height()).topLeft(), *pixmap);
+                p.end();
+                it.value().m_isPartialPixmap = it.value().m_isPartialPixmap || isPartialPixmap;
+                delete pixmap;
+                return;
+            }
+        }
         if (it != m_pixmaps.end()) {
             delete it.value().m_pixmap;
         } else {
@@ -655,6 +684,7 @@ void Page::addAnnotation(Annotation *annotation)
     }
     annotation->d_ptr->m_page = d;
     m_annotations.append(annotation);
+    d->annotationsChanged();
 
     AnnotationObjectRect *rect = new AnnotationObjectRect(annotation);
 
@@ -684,6 +714,7 @@ bool Page::removeAnnotation(Annotation *annotation)
             qCDebug(OkularCoreDebug) << "removed annotation:" << annotation->uniqueName();
             annotation->d_ptr->m_page = nullptr;
             m_annotations.erase(aIt);
+            d->annotationsChanged();
             break;
         }
     }
@@ -786,6 +817,7 @@ void Page::deleteAnnotations()
     // delete all stored annotations
     qDeleteAll(m_annotations);
     m_annotations.clear();
+    d->annotationsChanged();
 }
 
 bool PagePrivate::restoreLocalContents(const QDomNode &pageNode)
@@ -1003,6 +1035,11 @@ QList<Tile> Page::tilesAt(const DocumentObserver *observer, const NormalizedRect
         return QList<Tile>();
 }
 
+qulonglong PagePrivate::textPageMemoryUsage() const
+{
+    return m_text ? m_text->d->memoryUsage() : 0;
+}
+
 TilesManager *PagePrivate::tilesManager(const DocumentObserver *observer) const
 {
     return m_tilesManagers.value(observer);
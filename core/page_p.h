@@ -117,6 +117,11 @@ public:
      */
     void deleteTextSelections();
 
+    /**
+     * Returns the approximate memory used by the text page, in bytes
+     */
+    qulonglong textPageMemoryUsage() const;
+
     /**
      * Get the tiles manager for the tiled @p observer
      */
@@ -140,6 +145,11 @@ public:
 
     void setPixmap(DocumentObserver *observer, QPixmap *pixmap, const NormalizedRect &rect, bool isPartialPixmap);
 
+    /**
+     * Gives a new value to m_annotationsRevision.
+     */
+    void annotationsChanged();
+
     class PixmapObject
     {
     public:
@@ -167,6 +177,11 @@ public:
     double m_duration;
     QString m_label;
 
+    // changes whenever the annotations of the page change; the values are
+    // never shared by two pages, so what is cached for the annotations of a
+    // page is not used for a later page at the same address
+    int m_annotationsRevision;
+
     bool m_isBoundingBoxKnown : 1;
     QDomDocument restoredLocalAnnotationList; // <annotationList>...</annotationList>
     QDomDocument restoredFormFieldList;       // <forms>...</forms>
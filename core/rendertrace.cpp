@@ -0,0 +1,302 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by The Okular Developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "rendertrace_p.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+#include <QVector>
+
+#include "debug_p.h"
+#include "generator_p.h"
+
+// the events recorded after this many are dropped, so that a long session
+// doesn't use an unbounded amount of memory
+#define RENDERTRACE_MAXEVENTS 500000
+// the cache counters are sampled into the trace at most this often, in microseconds,
+// instead of once per lookup that would fill it up
+#define RENDERTRACE_COUNTERINTERVAL 100000
+// buckets of the render time histograms: < 1 ms, < 2 ms, < 4 ms, ... >= 16384 ms
+#define RENDERTRACE_HISTOGRAMBUCKETS 16
+
+using namespace Okular;
+
+namespace
+{
+struct TraceData {
+    TraceData()
+        : fileName(QFile::decodeName(qgetenv("OKULAR_RENDER_TRACE")))
+        , pid(QCoreApplication::applicationPid())
+    {
+        if (!fileName.isEmpty()) {
+            timer.start();
+        }
+    }
+
+    int threadId(Qt::HANDLE handle);
+    void appendEvent(const QByteArray &event);
+
+    const QString fileName;
+    const qint64 pid;
+    QElapsedTimer timer;
+
+    QMutex mutex;
+    QByteArray events;
+    int eventCount = 0;
+    int droppedEvents = 0;
+    QHash<Qt::HANDLE, int> threadIds;
+    quint64 nextRequestId = 1;
+    quint64 cacheHits = 0;
+    quint64 cacheMisses = 0;
+    quint64 evictions = 0;
+    qint64 cacheCountersTime = -1;
+    QHash<QString, QVector<quint64>> renderTimes;
+};
+
+Q_GLOBAL_STATIC(TraceData, traceData)
+
+int TraceData::threadId(Qt::HANDLE handle)
+{
+    auto it = threadIds.constFind(handle);
+    if (it != threadIds.constEnd())
+        return *it;
+
+    const int id = threadIds.count() + 1;
+    threadIds.insert(handle, id);
+
+    // name the thread in the trace viewers
+    const bool isMainThread = QCoreApplication::instance() && QThread::currentThread() == QCoreApplication::instance()->thread();
+    const QByteArray name = isMainThread ? QByteArrayLiteral("main") : QByteArrayLiteral("worker ") + QByteArray::number(id);
+    appendEvent(QByteArrayLiteral("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":") + QByteArray::number(pid) + QByteArrayLiteral(",\"tid\":") + QByteArray::number(id) + QByteArrayLiteral(",\"args\":{\"name\":\"") + name + QByteArrayLiteral("\"}}"));
+    return id;
+}
+
+void TraceData::appendEvent(const QByteArray &event)
+{
+    if (eventCount >= RENDERTRACE_MAXEVENTS) {
+        ++droppedEvents;
+        return;
+    }
+
+    if (eventCount > 0)
+        events += ",\n";
+    events += event;
+    ++eventCount;
+}
+
+QByteArray eventHeader(TraceData *data, const char *name, char phase, qint64 timestamp)
+{
+    return QByteArrayLiteral("{\"name\":\"") + name + QByteArrayLiteral("\",\"cat\":\"okular\",\"ph\":\"") + phase + QByteArrayLiteral("\",\"ts\":") + QByteArray::number(timestamp) + QByteArrayLiteral(",\"pid\":") + QByteArray::number(data->pid) +
+        QByteArrayLiteral(",\"tid\":") + QByteArray::number(data->threadId(QThread::currentThreadId()));
+}
+
+// the stages of a pixmap request are nested async slices of the same id,
+// since the requests overlap in time on the main thread
+void appendAsyncSlice(TraceData *data, const char *name, quint64 id, qint64 begin, qint64 end, const QByteArray &args = QByteArray())
+{
+    if (begin < 0 || end < begin)
+        return;
+
+    const QByteArray idField = QByteArrayLiteral(",\"id\":") + QByteArray::number(id);
+    data->appendEvent(eventHeader(data, name, 'b', begin) + idField + (args.isEmpty() ? QByteArray() : QByteArrayLiteral(",\"args\":{") + args + '}') + '}');
+    data->appendEvent(eventHeader(data, name, 'e', end) + idField + '}');
+}
+
+void appendCacheCounters(TraceData *data, qint64 timestamp)
+{
+    data->cacheCountersTime = timestamp;
+    data->appendEvent(eventHeader(data, "pixmap cache", 'C', timestamp) + QByteArrayLiteral(",\"args\":{\"hits\":") + QByteArray::number(data->cacheHits) + QByteArrayLiteral(",\"misses\":") + QByteArray::number(data->cacheMisses) +
+                      QByteArrayLiteral(",\"evictions\":") + QByteArray::number(data->evictions) + QByteArrayLiteral("}}"));
+}
+
+QByteArray jsonString(const QString &string)
+{
+    QByteArray result = "\"";
+    for (const char c : string.toUtf8()) {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        if (static_cast<uchar>(c) >= 0x20)
+            result += c;
+    }
+    return result + '"';
+}
+}
+
+bool RenderTrace::isEnabled()
+{
+    return !traceData->fileName.isEmpty();
+}
+
+qint64 RenderTrace::now()
+{
+    TraceData *data = traceData;
+    return data->timer.isValid() ? data->timer.nsecsElapsed() / 1000 : -1;
+}
+
+void RenderTrace::recordPixmapRequest(const PixmapRequestPrivate *request)
+{
+    const qint64 end = now();
+    if (end < 0 || request->mRequestedTime < 0)
+        return;
+
+    TraceData *data = traceData;
+    QMutexLocker locker(&data->mutex);
+    const quint64 id = data->nextRequestId++;
+    const bool sent = request->mSentTime >= 0;
+    const bool aborted = request->mShouldAbortRender.load() != 0;
+
+    QByteArray args = QByteArrayLiteral("\"page\":") + QByteArray::number(request->mPageNumber) + QByteArrayLiteral(",\"width\":") + QByteArray::number(request->mWidth) + QByteArrayLiteral(",\"height\":") + QByteArray::number(request->mHeight) +
+        QByteArrayLiteral(",\"priority\":") + QByteArray::number(request->mPriority) + QByteArrayLiteral(",\"tile\":") + (request->mTile ? "true" : "false") + QByteArrayLiteral(",\"result\":\"") +
+        (!sent ? "dropped" : aborted ? "aborted" : "done") + '"';
+
+    appendAsyncSlice(data, "pixmap request", id, request->mRequestedTime, end, args);
+    const qint64 queuedTime = request->mQueuedTime >= 0 ? request->mQueuedTime : end;
+    appendAsyncSlice(data, "preprocess", id, request->mRequestedTime, queuedTime);
+    if (request->mQueuedTime >= 0)
+        appendAsyncSlice(data, "queued", id, request->mQueuedTime, sent ? request->mSentTime : end);
+    if (sent) {
+        const qint64 doneTime = request->mDoneTime >= 0 ? request->mDoneTime : end;
+        appendAsyncSlice(data, "render", id, request->mSentTime, doneTime);
+        appendAsyncSlice(data, "generate", id, request->mGenerationStartTime, request->mGenerationEndTime);
+        if (request->mDoneTime >= 0)
+            appendAsyncSlice(data, "deliver", id, request->mDoneTime, end);
+    }
+}
+
+void RenderTrace::recordRenderTime(const QString &generator, qint64 duration)
+{
+    if (!isEnabled() || duration < 0)
+        return;
+
+    int bucket = 0;
+    for (qint64 ms = duration / 1000; ms > 0 && bucket < RENDERTRACE_HISTOGRAMBUCKETS - 1; ms >>= 1)
+        ++bucket;
+
+    TraceData *data = traceData;
+    QMutexLocker locker(&data->mutex);
+    QVector<quint64> &histogram = data->renderTimes[generator];
+    if (histogram.isEmpty())
+        histogram.fill(0, RENDERTRACE_HISTOGRAMBUCKETS);
+    ++histogram[bucket];
+}
+
+void RenderTrace::recordCacheLookup(bool hit)
+{
+    const qint64 timestamp = now();
+    if (timestamp < 0)
+        return;
+
+    TraceData *data = traceData;
+    QMutexLocker locker(&data->mutex);
+    if (hit)
+        ++data->cacheHits;
+    else
+        ++data->cacheMisses;
+    if (data->cacheCountersTime < 0 || timestamp - data->cacheCountersTime >= RENDERTRACE_COUNTERINTERVAL)
+        appendCacheCounters(data, timestamp);
+}
+
+void RenderTrace::recordEvictions(int count)
+{
+    const qint64 timestamp = now();
+    if (timestamp < 0 || count < 1)
+        return;
+
+    TraceData *data = traceData;
+    QMutexLocker locker(&data->mutex);
+    data->evictions += count;
+    if (data->cacheCountersTime < 0 || timestamp - data->cacheCountersTime >= RENDERTRACE_COUNTERINTERVAL)
+        appendCacheCounters(data, timestamp);
+}
+
+void RenderTrace::recordMemory(qulonglong pixmapsMemory, qulonglong textPagesMemory)
+{
+    const qint64 timestamp = now();
+    if (timestamp < 0)
+        return;
+
+    TraceData *data = traceData;
+    QMutexLocker locker(&data->mutex);
+    data->appendEvent(eventHeader(data, "memory", 'C', timestamp) + QByteArrayLiteral(",\"args\":{\"pixmaps\":") + QByteArray::number(pixmapsMemory) + QByteArrayLiteral(",\"text pages\":") + QByteArray::number(textPagesMemory) + QByteArrayLiteral("}}"));
+}
+
+void RenderTrace::write()
+{
+    if (!isEnabled())
+        return;
+
+    const qint64 timestamp = now();
+    TraceData *data = traceData;
+    QMutexLocker locker(&data->mutex);
+
+    // the last sample of the cache counters, with the lookups since the previous one
+    if (data->cacheCountersTime >= 0 && data->cacheCountersTime < timestamp)
+        appendCacheCounters(data, timestamp);
+
+    QByteArray histograms;
+    for (auto it = data->renderTimes.constBegin(); it != data->renderTimes.constEnd(); ++it) {
+        QByteArray buckets;
+        for (int i = 0; i < it->count(); ++i) {
+            if (it->at(i) == 0)
+                continue;
+            if (!buckets.isEmpty())
+                buckets += ',';
+            const QByteArray label = i < RENDERTRACE_HISTOGRAMBUCKETS - 1 ? "<" + QByteArray::number(1 << i) + "ms" : ">=" + QByteArray::number(1 << (i - 1)) + "ms";
+            buckets += '"' + label + "\":" + QByteArray::number(it->at(i));
+        }
+        if (!histograms.isEmpty())
+            histograms += ',';
+        histograms += jsonString(it.key()) + ":{" + buckets + '}';
+    }
+
+    QSaveFile file(data->fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(OkularCoreDebug) << "Could not write the render trace to" << data->fileName;
+        return;
+    }
+    file.write("{\"displayTimeUnit\":\"ms\",\n\"traceEvents\":[\n");
+    file.write(data->events);
+    file.write("],\n\"otherData\":{\"droppedEvents\":");
+    file.write(QByteArray::number(data->droppedEvents));
+    file.write(",\"cacheHits\":");
+    file.write(QByteArray::number(data->cacheHits));
+    file.write(",\"cacheMisses\":");
+    file.write(QByteArray::number(data->cacheMisses));
+    file.write(",\"evictions\":");
+    file.write(QByteArray::number(data->evictions));
+    file.write("},\n\"renderTimeHistograms\":{");
+    file.write(histograms);
+    file.write("}}\n");
+    if (!file.commit())
+        qCWarning(OkularCoreDebug) << "Could not write the render trace to" << data->fileName;
+}
+
+RenderTrace::Scope::Scope(const char *name, int pageNumber)
+    : m_name(name)
+    , m_pageNumber(pageNumber)
+    , m_start(now())
+{
+}
+
+RenderTrace::Scope::~Scope()
+{
+    if (m_start < 0)
+        return;
+
+    const qint64 end = now();
+    TraceData *data = traceData;
+    QMutexLocker locker(&data->mutex);
+    data->appendEvent(eventHeader(data, m_name, 'X', m_start) + QByteArrayLiteral(",\"dur\":") + QByteArray::number(end - m_start) + QByteArrayLiteral(",\"args\":{\"page\":") + QByteArray::number(m_pageNumber) + QByteArrayLiteral("}}"));
+}
@@ -0,0 +1,102 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by The Okular Developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_RENDERTRACE_P_H_
+#define _OKULAR_RENDERTRACE_P_H_
+
+#include <QtGlobal>
+
+#include "okularcore_export.h"
+
+class QString;
+
+namespace Okular
+{
+class PixmapRequestPrivate;
+
+/**
+ * Records the life of the pixmap requests, the use of the pixmap cache and
+ * the memory used by the document as a trace in the Chrome trace event
+ * format, that can be opened in chrome://tracing or in Perfetto.
+ *
+ * The trace is only recorded when the OKULAR_RENDER_TRACE environment
+ * variable contains the name of the file to write it to; the file is
+ * (re)written every time a document is closed.
+ */
+class OKULARCORE_EXPORT RenderTrace
+{
+public:
+    /**
+     * Returns whether the trace is being recorded.
+     */
+    static bool isEnabled();
+
+    /**
+     * Returns the time elapsed since the start of the trace in microseconds,
+     * or -1 if the trace is not being recorded.
+     */
+    static qint64 now();
+
+    /**
+     * Records the stages of the pixmap @p request, from the creation of the
+     * request to its deletion.
+     */
+    static void recordPixmapRequest(const PixmapRequestPrivate *request);
+
+    /**
+     * Adds the @p duration (in microseconds) of the generation of a pixmap
+     * to the render time histogram of the @p generator.
+     */
+    static void recordRenderTime(const QString &generator, qint64 duration);
+
+    /**
+     * Counts a pixmap cache lookup, which is a @p hit when the cached pixmap
+     * or tiles can be painted as they are. The totals are sampled into the
+     * trace at a fixed interval and when it is written.
+     */
+    static void recordCacheLookup(bool hit);
+
+    /**
+     * Counts @p count pixmaps evicted from the pixmap cache.
+     */
+    static void recordEvictions(int count);
+
+    /**
+     * Records the memory used by the pixmaps and the text pages.
+     */
+    static void recordMemory(qulonglong pixmapsMemory, qulonglong textPagesMemory);
+
+    /**
+     * Writes the trace recorded so far to the file.
+     */
+    static void write();
+
+    /**
+     * Records the time spent in the scope of the object as the @p name
+     * stage of the page @p pageNumber.
+     */
+    class OKULARCORE_EXPORT Scope
+    {
+    public:
+        Scope(const char *name, int pageNumber);
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        const char *m_name;
+        int m_pageNumber;
+        qint64 m_start;
+    };
+};
+
+}
+
+#endif
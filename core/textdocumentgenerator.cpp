@@ -264,12 +264,15 @@ void TextDocumentGeneratorPrivate::initializeGenerator()
 #ifdef OKULAR_TEXTDOCUMENT_THREADED_RENDERING
     q->setFeature(Generator::Threaded);
 #endif
+    q->setFeature(Generator::AsynchronousLoading);
 
-    QObject::connect(mConverter, &TextDocumentConverter::addAction, q, [this](Action *a, int cb, int ce) { addAction(a, cb, ce); });
-    QObject::connect(mConverter, &TextDocumentConverter::addAnnotation, q, [this](Annotation *a, int cb, int ce) { addAnnotation(a, cb, ce); });
-    QObject::connect(mConverter, &TextDocumentConverter::addTitle, q, [this](int l, const QString &t, const QTextBlock &b) { addTitle(l, t, b); });
-    QObject::connect(mConverter, QOverload<const QString &, const QString &, const QString &>::of(&TextDocumentConverter::addMetaData), q, [this](const QString &k, const QString &v, const QString &t) { addMetaData(k, v, t); });
-    QObject::connect(mConverter, QOverload<DocumentInfo::Key, const QString &>::of(&TextDocumentConverter::addMetaData), q, [this](DocumentInfo::Key k, const QString &v) { addMetaData(k, v); });
+    // the converter may run in the load thread, collect what it finds there
+    QObject::connect(mConverter, &TextDocumentConverter::addAction, q, [this](Action *a, int cb, int ce) { addAction(a, cb, ce); }, Qt::DirectConnection);
+    QObject::connect(mConverter, &TextDocumentConverter::addAnnotation, q, [this](Annotation *a, int cb, int ce) { addAnnotation(a, cb, ce); }, Qt::DirectConnection);
+    QObject::connect(mConverter, &TextDocumentConverter::addTitle, q, [this](int l, const QString &t, const QTextBlock &b) { addTitle(l, t, b); }, Qt::DirectConnection);
+    QObject::connect(
+        mConverter, QOverload<const QString &, const QString &, const QString &>::of(&TextDocumentConverter::addMetaData), q, [this](const QString &k, const QString &v, const QString &t) { addMetaData(k, v, t); }, Qt::DirectConnection);
+    QObject::connect(mConverter, QOverload<DocumentInfo::Key, const QString &>::of(&TextDocumentConverter::addMetaData), q, [this](DocumentInfo::Key k, const QString &v) { addMetaData(k, v); }, Qt::DirectConnection);
 
     QObject::connect(mConverter, &TextDocumentConverter::error, q, &Generator::error);
     QObject::connect(mConverter, &TextDocumentConverter::warning, q, &Generator::warning);
@@ -289,39 +292,38 @@ TextDocumentGenerator::~TextDocumentGenerator()
 {
 }
 
-Document::OpenResult TextDocumentGenerator::loadDocumentWithPassword(const QString &fileName, QVector<Okular::Page *> &pagesVector, const QString &password)
+Document::OpenResult TextDocumentGeneratorPrivate::loadDocument(const QString &fileName, const QString &password, QVector<Okular::Page *> &pagesVector)
 {
-    Q_D(TextDocumentGenerator);
-    const Document::OpenResult openResult = d->mConverter->convertWithPassword(fileName, password);
+    const Document::OpenResult openResult = mConverter->convertWithPassword(fileName, password);
 
     if (openResult != Document::OpenSuccess) {
-        d->mDocument = nullptr;
+        mDocument = nullptr;
 
         // loading failed, cleanup all the stuff eventually gathered from the converter
-        d->mTitlePositions.clear();
-        for (const TextDocumentGeneratorPrivate::LinkPosition &linkPos : qAsConst(d->mLinkPositions)) {
+        mTitlePositions.clear();
+        for (const LinkPosition &linkPos : qAsConst(mLinkPositions)) {
             delete linkPos.link;
         }
-        d->mLinkPositions.clear();
-        for (const TextDocumentGeneratorPrivate::AnnotationPosition &annPos : qAsConst(d->mAnnotationPositions)) {
+        mLinkPositions.clear();
+        for (const AnnotationPosition &annPos : qAsConst(mAnnotationPositions)) {
             delete annPos.annotation;
         }
-        d->mAnnotationPositions.clear();
+        mAnnotationPositions.clear();
 
         return openResult;
     }
-    d->mDocument = d->mConverter->document();
+    mDocument = mConverter->document();
 
-    d->generateTitleInfos();
-    const QList<TextDocumentGeneratorPrivate::LinkInfo> linkInfos = d->generateLinkInfos();
-    const QList<TextDocumentGeneratorPrivate::AnnotationInfo> annotationInfos = d->generateAnnotationInfos();
+    generateTitleInfos();
+    const QList<LinkInfo> linkInfos = generateLinkInfos();
+    const QList<AnnotationInfo> annotationInfos = generateAnnotationInfos();
 
-    pagesVector.resize(d->mDocument->pageCount());
+    pagesVector.resize(mDocument->pageCount());
 
-    const QSize size = d->mDocument->pageSize().toSize();
+    const QSize size = mDocument->pageSize().toSize();
 
-    QVector<QLinkedList<Okular::ObjectRect *>> objects(d->mDocument->pageCount());
-    for (const TextDocumentGeneratorPrivate::LinkInfo &info : linkInfos) {
+    QVector<QLinkedList<Okular::ObjectRect *>> objects(mDocument->pageCount());
+    for (const LinkInfo &info : linkInfos) {
         // in case that the converter report bogus link info data, do not assert here
         if (info.page < 0 || info.page >= objects.count())
             continue;
@@ -334,12 +336,12 @@ Document::OpenResult TextDocumentGenerator::loadDocumentWithPassword(const QStri
         }
     }
 
-    QVector<QLinkedList<Okular::Annotation *>> annots(d->mDocument->pageCount());
-    for (const TextDocumentGeneratorPrivate::AnnotationInfo &info : annotationInfos) {
+    QVector<QLinkedList<Okular::Annotation *>> annots(mDocument->pageCount());
+    for (const AnnotationInfo &info : annotationInfos) {
         annots[info.page].append(info.annotation);
     }
 
-    for (int i = 0; i < d->mDocument->pageCount(); ++i) {
+    for (int i = 0; i < mDocument->pageCount(); ++i) {
         Okular::Page *page = new Okular::Page(i, size.width(), size.height(), Okular::Rotation0);
         pagesVector[i] = page;
 
@@ -355,9 +357,84 @@ Document::OpenResult TextDocumentGenerator::loadDocumentWithPassword(const QStri
     return openResult;
 }
 
+void TextDocumentGeneratorPrivate::startLoading(const QString &fileName, const QString &password)
+{
+    Q_Q(TextDocumentGenerator);
+
+    mLoadThread = new TextDocumentLoadThread(this, fileName, password);
+    QObject::connect(mLoadThread, &QThread::finished, q, [this] { loadingFinished(); });
+    mLoadThread->start(QThread::InheritPriority);
+}
+
+void TextDocumentGeneratorPrivate::loadingFinished()
+{
+    Q_Q(TextDocumentGenerator);
+
+    TextDocumentLoadThread *loadThread = mLoadThread;
+    mLoadThread = nullptr;
+    const QVector<Okular::Page *> pages = loadThread->pages();
+    delete loadThread;
+
+    q->signalDocumentLoadingDone(pages);
+}
+
+void TextDocumentGeneratorPrivate::abortLoading()
+{
+    if (!mLoadThread)
+        return;
+
+    // the converter can not be interrupted, wait for it and drop what it loaded
+    mLoadThread->disconnect();
+    mLoadThread->wait();
+    qDeleteAll(mLoadThread->pages());
+    delete mLoadThread;
+    mLoadThread = nullptr;
+}
+
+TextDocumentLoadThread::TextDocumentLoadThread(TextDocumentGeneratorPrivate *generator, const QString &fileName, const QString &password)
+    : mGenerator(generator)
+    , mFileName(fileName)
+    , mPassword(password)
+{
+}
+
+QVector<Page *> TextDocumentLoadThread::pages() const
+{
+    return mPages;
+}
+
+void TextDocumentLoadThread::run()
+{
+    if (mGenerator->loadDocument(mFileName, mPassword, mPages) != Document::OpenSuccess) {
+        qDeleteAll(mPages);
+        mPages.clear();
+        return;
+    }
+
+    // the document is used in the thread of the generator from now on
+    mGenerator->mDocument->moveToThread(mGenerator->q_ptr->thread());
+}
+
+Document::OpenResult TextDocumentGenerator::loadDocumentWithPassword(const QString &fileName, QVector<Okular::Page *> &pagesVector, const QString &password)
+{
+    Q_D(TextDocumentGenerator);
+
+    // when asked to, convert the document in the background and provide a
+    // single page of the usual size of the converted documents meanwhile
+    if (hasFeature(AsynchronousLoading) && document() && document()->openAsynchronously()) {
+        d->startLoading(fileName, password);
+        pagesVector.resize(1);
+        pagesVector[0] = new Okular::Page(0, 600, 800, Okular::Rotation0);
+        return Document::OpenSuccess;
+    }
+
+    return d->loadDocument(fileName, password, pagesVector);
+}
+
 bool TextDocumentGenerator::doCloseDocument()
 {
     Q_D(TextDocumentGenerator);
+    d->abortLoading();
     delete d->mDocument;
     d->mDocument = nullptr;
 
@@ -430,13 +507,16 @@ QImage TextDocumentGeneratorPrivate::image(PixmapRequest *request)
 Okular::TextPage *TextDocumentGenerator::textPage(Okular::TextRequest *request)
 {
     Q_D(TextDocumentGenerator);
+    if (d->mLoadThread)
+        return nullptr;
     return d->createTextPage(request->page()->number());
 }
 
 bool TextDocumentGenerator::print(QPrinter &printer)
 {
     Q_D(TextDocumentGenerator);
-    if (!d->mDocument)
+    // the load thread sets mDocument, do not read it before the thread is done
+    if (d->mLoadThread || !d->mDocument)
         return false;
 
     d->mDocument->print(&printer);
@@ -447,13 +527,15 @@ bool TextDocumentGenerator::print(QPrinter &printer)
 Okular::DocumentInfo TextDocumentGenerator::generateDocumentInfo(const QSet<DocumentInfo::Key> & /*keys*/) const
 {
     Q_D(const TextDocumentGenerator);
+    if (d->mLoadThread)
+        return Okular::DocumentInfo();
     return d->mDocumentInfo;
 }
 
 const Okular::DocumentSynopsis *TextDocumentGenerator::generateDocumentSynopsis()
 {
     Q_D(TextDocumentGenerator);
-    if (!d->mDocumentSynopsis.hasChildNodes())
+    if (d->mLoadThread || !d->mDocumentSynopsis.hasChildNodes())
         return nullptr;
     else
         return &d->mDocumentSynopsis;
@@ -462,6 +544,8 @@ const Okular::DocumentSynopsis *TextDocumentGenerator::generateDocumentSynopsis(
 QVariant TextDocumentGeneratorPrivate::metaData(const QString &key, const QVariant &option) const
 {
     Q_UNUSED(option)
+    if (mLoadThread)
+        return QVariant();
     if (key == QLatin1String("DocumentTitle")) {
         return mDocumentInfo.get(DocumentInfo::Title);
     }
@@ -488,7 +572,8 @@ Okular::ExportFormat::List TextDocumentGenerator::exportFormats() const
 bool TextDocumentGenerator::exportTo(const QString &fileName, const Okular::ExportFormat &format)
 {
     Q_D(TextDocumentGenerator);
-    if (!d->mDocument)
+    // the load thread sets mDocument, do not read it before the thread is done
+    if (d->mLoadThread || !d->mDocument)
         return false;
 
     if (format.mimeType().name() == QLatin1String("application/pdf")) {
@@ -565,4 +650,7 @@ void TextDocumentGenerator::setTextDocument(QTextDocument *textDocument)
     for (Page *p : qAsConst(d->m_document->m_pagesVector)) {
         p->setTextPage(nullptr);
     }
+    d->m_document->m_allocatedTextPages.clear();
+    d->m_document->m_allocatedTextPagesMemory.clear();
+    d->m_document->m_allocatedTextPagesTotalMemory = 0;
 }
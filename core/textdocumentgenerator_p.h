@@ -13,6 +13,7 @@
 #include <QAbstractTextDocumentLayout>
 #include <QTextBlock>
 #include <QTextDocument>
+#include <QThread>
 
 #include "action.h"
 #include "debug_p.h"
@@ -164,6 +165,29 @@ public:
     QTextDocument *mDocument;
 };
 
+class TextDocumentGeneratorPrivate;
+
+/**
+ * Converts the document and creates its pages in the background,
+ * when the document is opened asynchronously.
+ */
+class TextDocumentLoadThread : public QThread
+{
+public:
+    TextDocumentLoadThread(TextDocumentGeneratorPrivate *generator, const QString &fileName, const QString &password);
+
+    QVector<Page *> pages() const;
+
+protected:
+    void run() override;
+
+private:
+    TextDocumentGeneratorPrivate *mGenerator;
+    QString mFileName;
+    QString mPassword;
+    QVector<Page *> mPages;
+};
+
 class TextDocumentGeneratorPrivate : public GeneratorPrivate
 {
     friend class TextDocumentConverter;
@@ -172,18 +196,25 @@ public:
     explicit TextDocumentGeneratorPrivate(TextDocumentConverter *converter)
         : mConverter(converter)
         , mDocument(nullptr)
+        , mLoadThread(nullptr)
         , mGeneralSettings(nullptr)
     {
     }
 
     ~TextDocumentGeneratorPrivate() override
     {
+        abortLoading();
         delete mConverter;
         delete mDocument;
     }
 
     void initializeGenerator();
 
+    Document::OpenResult loadDocument(const QString &fileName, const QString &password, QVector<Page *> &pagesVector);
+    void startLoading(const QString &fileName, const QString &password);
+    void loadingFinished();
+    void abortLoading();
+
     struct LinkInfo {
         int page;
         QRectF boundingRect;
@@ -219,6 +250,9 @@ public:
     TextDocumentConverter *mConverter;
 
     QTextDocument *mDocument;
+    // set while the document is loaded in the background, only used in the
+    // thread of the generator
+    TextDocumentLoadThread *mLoadThread;
     Okular::DocumentInfo mDocumentInfo;
     Okular::DocumentSynopsis mDocumentSynopsis;
 
@@ -169,6 +169,11 @@ public:
         return transformed_area;
     }
 
+    inline int memoryUsage() const
+    {
+        return sizeof(TinyTextEntity) + (length > MaxStaticChars ? length * sizeof(QChar) : 0);
+    }
+
     NormalizedRect area;
 
 private:
@@ -1065,6 +1070,14 @@ void TextPagePrivate::setWordList(const TextList &list)
     m_words = list;
 }
 
+qulonglong TextPagePrivate::memoryUsage() const
+{
+    qulonglong memory = sizeof(TextPage) + sizeof(TextPagePrivate) + m_words.count() * sizeof(void *);
+    for (const TinyTextEntity *word : m_words)
+        memory += word->memoryUsage();
+    return memory;
+}
+
 /**
  * Remove all the spaces in between texts. It will make all the generators
  * same, whether they save spaces(like pdf) or not(like djvu).
@@ -65,6 +65,11 @@ public:
      */
     void correctTextOrder();
 
+    /**
+     * Returns the approximate memory used by the text entities, in bytes
+     */
+    qulonglong memoryUsage() const;
+
     // variables those can be accessed directly from TextPage
     TextList m_words;
     QMap<int, SearchPoint *> m_searchPoints;
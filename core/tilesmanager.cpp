@@ -16,6 +16,8 @@
 #include "tile.h"
 
 #define TILES_MAXSIZE 2000000
+// Number of levels of detail kept besides the current one
+#define TILES_MAXLEVELS 2
 
 using namespace Okular;
 
@@ -28,6 +30,44 @@ static bool rankedTilesLessThan(TileNode *t1, TileNode *t2)
     return !t1->dirty;
 }
 
+/**
+ * The tiles of the page at a size other than the current one.
+ */
+struct TileLevel {
+    int width;
+    int height;
+    TileNode tiles[16];
+};
+
+/**
+ * Moves the 16 tiles of the first level of the tree from @p from to @p to,
+ * leaving empty tiles in @p from
+ */
+static void moveTiles(TileNode *from, TileNode *to)
+{
+    for (int i = 0; i < 16; ++i) {
+        to[i] = from[i];
+        for (int j = 0; j < to[i].nTiles; ++j)
+            to[i].tiles[j].parent = &to[i];
+
+        from[i] = TileNode();
+        from[i].rect = to[i].rect;
+    }
+}
+
+static bool hasAnyPixmap(const TileNode &tile)
+{
+    if (tile.pixmap)
+        return true;
+
+    for (int i = 0; i < tile.nTiles; ++i) {
+        if (hasAnyPixmap(tile.tiles[i]))
+            return true;
+    }
+
+    return false;
+}
+
 class TilesManager::Private
 {
 public:
@@ -42,13 +82,58 @@ public:
      */
     static void markDirty(TileNode &tile);
 
+    /**
+     * Mark @p tile and all its children intersecting with @p rect as dirty
+     */
+    static void markDirty(TileNode &tile, const NormalizedRect &rect);
+
     /**
      * Deletes all tiles, recursively
      */
     void deleteTiles(const TileNode &tile);
 
     void markParentDirty(const TileNode &tile);
-    void rankTiles(TileNode &tile, QList<TileNode *> &rankedTiles, const NormalizedRect &visibleRect, int visiblePageNumber);
+    void rankTiles(TileNode &tile, QList<TileNode *> &rankedTiles, const NormalizedRect &visibleRect, int visiblePageNumber, double levelDistance = 0);
+
+    /**
+     * Rotates the pixmap of @p tile to the current rotation, if needed
+     */
+    void rotateTile(TileNode &tile);
+
+    /**
+     * Appends the tiles with pixmap of a level of detail intersecting
+     * with @p rect to @p result. Tiles are never split.
+     */
+    void levelTilesAt(const NormalizedRect &rect, TileNode &tile, QList<Tile> &result);
+
+    /**
+     * Keeps the current tiles as a level of detail, and leaves the
+     * current tiles empty.
+     */
+    void storeCurrentLevel();
+
+    /**
+     * Makes the level of detail of the current size the current tiles,
+     * if there's one. Returns whether it was found.
+     */
+    bool restoreLevel();
+
+    /**
+     * Deletes the levels of detail that are the farthest from the current
+     * size, so that no more than TILES_MAXLEVELS are kept
+     */
+    void limitLevels();
+
+    /**
+     * Distance between the size of @p level and the current size, as the
+     * number of times the page would have to be zoomed in or out by 2x
+     */
+    double levelDistance(const TileLevel *level) const;
+
+    TileLevel *closestLevel() const;
+
+    void deleteLevel(TileLevel *level);
+
     /**
      * Since the tile can be large enough to occupy a significant amount of
      * space, they may be split in more tiles. This operation is performed
@@ -67,6 +152,8 @@ public:
 
     // The page is split in a 4x4 grid of tiles
     TileNode tiles[16];
+    // The tiles at other sizes
+    QList<TileLevel *> levels;
     int width;
     int height;
     int pageNumber;
@@ -112,9 +199,20 @@ TilesManager::~TilesManager()
     for (const TileNode &tile : d->tiles)
         d->deleteTiles(tile);
 
+    for (TileLevel *level : qAsConst(d->levels))
+        d->deleteLevel(level);
+
     delete d;
 }
 
+void TilesManager::Private::deleteLevel(TileLevel *level)
+{
+    for (const TileNode &tile : level->tiles)
+        deleteTiles(tile);
+
+    delete level;
+}
+
 void TilesManager::Private::deleteTiles(const TileNode &tile)
 {
     if (tile.pixmap) {
@@ -135,10 +233,88 @@ void TilesManager::setSize(int width, int height)
     if (width == d->width && height == d->height)
         return;
 
+    d->storeCurrentLevel();
+
     d->width = width;
     d->height = height;
 
-    markDirty();
+    d->restoreLevel();
+    d->limitLevels();
+}
+
+void TilesManager::Private::storeCurrentLevel()
+{
+    bool hasPixmaps = false;
+    for (const TileNode &tile : tiles) {
+        if (hasAnyPixmap(tile)) {
+            hasPixmaps = true;
+            break;
+        }
+    }
+
+    if (!hasPixmaps) {
+        for (TileNode &tile : tiles) {
+            deleteTiles(tile);
+            const NormalizedRect rect = tile.rect;
+            tile = TileNode();
+            tile.rect = rect;
+        }
+        return;
+    }
+
+    TileLevel *level = new TileLevel;
+    level->width = width;
+    level->height = height;
+    moveTiles(tiles, level->tiles);
+    levels.append(level);
+}
+
+bool TilesManager::Private::restoreLevel()
+{
+    for (int i = 0; i < levels.count(); ++i) {
+        TileLevel *level = levels.at(i);
+        if (level->width == width && level->height == height) {
+            moveTiles(level->tiles, tiles);
+            levels.removeAt(i);
+            delete level;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void TilesManager::Private::limitLevels()
+{
+    while (levels.count() > TILES_MAXLEVELS) {
+        int farthest = 0;
+        for (int i = 1; i < levels.count(); ++i) {
+            if (levelDistance(levels.at(i)) > levelDistance(levels.at(farthest)))
+                farthest = i;
+        }
+
+        deleteLevel(levels.takeAt(farthest));
+    }
+}
+
+double TilesManager::Private::levelDistance(const TileLevel *level) const
+{
+    if (level->width <= 0 || width <= 0)
+        return 0;
+
+    return qAbs(std::log2((double)level->width / width));
+}
+
+TileLevel *TilesManager::Private::closestLevel() const
+{
+    TileLevel *closest = nullptr;
+    for (TileLevel *level : levels) {
+        // on a tie, the sharper level is better
+        if (!closest || levelDistance(level) < levelDistance(closest) || (levelDistance(level) == levelDistance(closest) && level->width > closest->width))
+            closest = level;
+    }
+
+    return closest;
 }
 
 int TilesManager::width() const
@@ -169,6 +345,12 @@ void TilesManager::markDirty()
     for (TileNode &tile : d->tiles) {
         TilesManager::Private::markDirty(tile);
     }
+
+    for (TileLevel *level : qAsConst(d->levels)) {
+        for (TileNode &tile : level->tiles) {
+            TilesManager::Private::markDirty(tile);
+        }
+    }
 }
 
 void TilesManager::Private::markDirty(TileNode &tile)
@@ -180,6 +362,33 @@ void TilesManager::Private::markDirty(TileNode &tile)
     }
 }
 
+void TilesManager::markDirty(const NormalizedRect &rect)
+{
+    const NormalizedRect rotatedRect = fromRotatedRect(rect, d->rotation);
+
+    for (TileNode &tile : d->tiles) {
+        TilesManager::Private::markDirty(tile, rotatedRect);
+    }
+
+    for (TileLevel *level : qAsConst(d->levels)) {
+        for (TileNode &tile : level->tiles) {
+            TilesManager::Private::markDirty(tile, rotatedRect);
+        }
+    }
+}
+
+void TilesManager::Private::markDirty(TileNode &tile, const NormalizedRect &rect)
+{
+    if (!tile.rect.intersects(rect))
+        return;
+
+    tile.dirty = true;
+
+    for (int i = 0; i < tile.nTiles; ++i) {
+        markDirty(tile.tiles[i], rect);
+    }
+}
+
 void TilesManager::setPixmap(const QPixmap *pixmap, const NormalizedRect &rect, bool isPartialPixmap)
 {
     const NormalizedRect rotatedRect = TilesManager::fromRotatedRect(rect, d->rotation);
@@ -345,6 +554,14 @@ QList<Tile> TilesManager::tilesAt(const NormalizedRect &rect, TileLeaf tileLeaf)
     QList<Tile> result;
 
     NormalizedRect rotatedRect = fromRotatedRect(rect, d->rotation);
+
+    if (tileLeaf == PixmapTile && !d->levels.isEmpty() && !hasPixmap(rect)) {
+        TileLevel *level = d->closestLevel();
+        for (TileNode &tile : level->tiles) {
+            d->levelTilesAt(rotatedRect, tile, result);
+        }
+    }
+
     for (TileNode &tile : d->tiles) {
         d->tilesAt(rotatedRect, tile, result, tileLeaf);
     }
@@ -352,6 +569,20 @@ QList<Tile> TilesManager::tilesAt(const NormalizedRect &rect, TileLeaf tileLeaf)
     return result;
 }
 
+void TilesManager::Private::levelTilesAt(const NormalizedRect &rect, TileNode &tile, QList<Tile> &result)
+{
+    if (!tile.rect.intersects(rect))
+        return;
+
+    if (tile.pixmap) {
+        rotateTile(tile);
+        result.append(Tile(TilesManager::toRotatedRect(tile.rect, rotation), tile.pixmap, false));
+    } else {
+        for (int i = 0; i < tile.nTiles; ++i)
+            levelTilesAt(rect, tile.tiles[i], result);
+    }
+}
+
 void TilesManager::Private::tilesAt(const NormalizedRect &rect, TileNode &tile, QList<Tile> &result, TileLeaf tileLeaf)
 {
     if (!tile.rect.intersects(rect))
@@ -368,51 +599,9 @@ void TilesManager::Private::tilesAt(const NormalizedRect &rect, TileNode &tile,
         else
             rotatedRect = tile.rect;
 
-        if (tile.pixmap && tileLeaf == PixmapTile && tile.rotation != rotation) {
-            // Lazy tiles rotation
-            int angleToRotate = (rotation - tile.rotation) * 90;
-            int xOffset = 0, yOffset = 0;
-            int w = 0, h = 0;
-            switch (angleToRotate) {
-            case 0:
-                xOffset = 0;
-                yOffset = 0;
-                w = tile.pixmap->width();
-                h = tile.pixmap->height();
-                break;
-            case 90:
-            case -270:
-                xOffset = 0;
-                yOffset = -tile.pixmap->height();
-                w = tile.pixmap->height();
-                h = tile.pixmap->width();
-                break;
-            case 180:
-            case -180:
-                xOffset = -tile.pixmap->width();
-                yOffset = -tile.pixmap->height();
-                w = tile.pixmap->width();
-                h = tile.pixmap->height();
-                break;
-            case 270:
-            case -90:
-                xOffset = -tile.pixmap->width();
-                yOffset = 0;
-                w = tile.pixmap->height();
-                h = tile.pixmap->width();
-                break;
-            }
-            QPixmap *rotatedPixmap = new QPixmap(w, h);
-            QPainter p(rotatedPixmap);
-            p.rotate(angleToRotate);
-            p.translate(xOffset, yOffset);
-            p.drawPixmap(0, 0, *tile.pixmap);
-            p.end();
+        if (tileLeaf == PixmapTile)
+            rotateTile(tile);
 
-            delete tile.pixmap;
-            tile.pixmap = rotatedPixmap;
-            tile.rotation = rotation;
-        }
         result.append(Tile(rotatedRect, tile.pixmap, tile.isValid()));
     } else {
         for (int i = 0; i < tile.nTiles; ++i)
@@ -420,6 +609,55 @@ void TilesManager::Private::tilesAt(const NormalizedRect &rect, TileNode &tile,
     }
 }
 
+void TilesManager::Private::rotateTile(TileNode &tile)
+{
+    if (tile.pixmap && tile.rotation != rotation) {
+        // Lazy tiles rotation
+        int angleToRotate = (rotation - tile.rotation) * 90;
+        int xOffset = 0, yOffset = 0;
+        int w = 0, h = 0;
+        switch (angleToRotate) {
+        case 0:
+            xOffset = 0;
+            yOffset = 0;
+            w = tile.pixmap->width();
+            h = tile.pixmap->height();
+            break;
+        case 90:
+        case -270:
+            xOffset = 0;
+            yOffset = -tile.pixmap->height();
+            w = tile.pixmap->height();
+            h = tile.pixmap->width();
+            break;
+        case 180:
+        case -180:
+            xOffset = -tile.pixmap->width();
+            yOffset = -tile.pixmap->height();
+            w = tile.pixmap->width();
+            h = tile.pixmap->height();
+            break;
+        case 270:
+        case -90:
+            xOffset = -tile.pixmap->width();
+            yOffset = 0;
+            w = tile.pixmap->height();
+            h = tile.pixmap->width();
+            break;
+        }
+        QPixmap *rotatedPixmap = new QPixmap(w, h);
+        QPainter p(rotatedPixmap);
+        p.rotate(angleToRotate);
+        p.translate(xOffset, yOffset);
+        p.drawPixmap(0, 0, *tile.pixmap);
+        p.end();
+
+        delete tile.pixmap;
+        tile.pixmap = rotatedPixmap;
+        tile.rotation = rotation;
+    }
+}
+
 qulonglong TilesManager::totalMemory() const
 {
     return 4 * d->totalPixels;
@@ -433,13 +671,36 @@ void TilesManager::cleanupPixmapMemory(qulonglong numberOfBytes, const Normalize
     }
     std::sort(rankedTiles.begin(), rankedTiles.end(), rankedTilesLessThan);
 
+    // The tiles of the other levels of detail are removed first, starting
+    // with the levels the farthest from the current size
+    QList<TileNode *> rankedLevelTiles;
+    for (TileLevel *level : qAsConst(d->levels)) {
+        for (TileNode &tile : level->tiles) {
+            d->rankTiles(tile, rankedLevelTiles, visibleRect, visiblePageNumber, d->levelDistance(level) * 2);
+        }
+    }
+    std::sort(rankedLevelTiles.begin(), rankedLevelTiles.end(), rankedTilesLessThan);
+    const int currentTilesCount = rankedTiles.count();
+    rankedTiles += rankedLevelTiles;
+
+    // visible tiles of other levels are only needed until the visible
+    // tiles of the current size are available
+    bool currentVisibleTilesAvailable = true;
+    for (const TileNode &tile : qAsConst(d->tiles)) {
+        if (!d->hasPixmap(visibleRect, tile)) {
+            currentVisibleTilesAvailable = false;
+            break;
+        }
+    }
+
     while (numberOfBytes > 0 && !rankedTiles.isEmpty()) {
+        const bool isLevelTile = rankedTiles.count() > currentTilesCount;
         TileNode *tile = rankedTiles.takeLast();
         if (!tile->pixmap)
             continue;
 
         // do not evict visible pixmaps
-        if (tile->rect.intersects(visibleRect))
+        if (tile->rect.intersects(visibleRect) && !(isLevelTile && currentVisibleTilesAvailable))
             continue;
 
         qulonglong pixels = tile->pixmap->width() * tile->pixmap->height();
@@ -467,7 +728,7 @@ void TilesManager::Private::markParentDirty(const TileNode &tile)
     }
 }
 
-void TilesManager::Private::rankTiles(TileNode &tile, QList<TileNode *> &rankedTiles, const NormalizedRect &visibleRect, int visiblePageNumber)
+void TilesManager::Private::rankTiles(TileNode &tile, QList<TileNode *> &rankedTiles, const NormalizedRect &visibleRect, int visiblePageNumber, double levelDistance)
 {
     // If the page is visible, visibleRect is not null.
     // Otherwise we use the number of one of the visible pages to calculate the
@@ -492,10 +753,11 @@ void TilesManager::Private::rankTiles(TileNode &tile, QList<TileNode *> &rankedT
             else
                 tile.distance = tile.rect.top;
         }
+        tile.distance += levelDistance;
         rankedTiles.append(&tile);
     } else {
         for (int i = 0; i < tile.nTiles; ++i) {
-            rankTiles(tile.tiles[i], rankedTiles, visibleRect, visiblePageNumber);
+            rankTiles(tile.tiles[i], rankedTiles, visibleRect, visiblePageNumber, levelDistance);
         }
     }
 }
@@ -94,8 +94,13 @@ public:
  * The tiles manager is a tree of tiles. At first the page is divided in a 4x4
  * grid of 16 tiles. Then each of these tiles can be recursively split in 4
  * subtiles so that we keep the size of each pixmap inside a safe interval.
+ *
+ * When the size of the page changes, the tiles of the previous size are
+ * kept as a level of detail (a few levels at most). They are painted where
+ * the tiles of the current size are not available yet, and they are used
+ * again without any repaint if the page gets back to their size.
  */
-class TilesManager
+class OKULARCORE_EXPORT TilesManager
 {
 public:
     enum TileLeaf {
@@ -133,6 +138,10 @@ public:
      * As to avoid requests of big areas, each traversed tile is checked
      * for its size and split if necessary.
      *
+     * If @p tileLeaf is PixmapTile and the area is not fully available at
+     * the current size, the tiles of the closest level of detail come
+     * first in the list, so that the current ones are painted over them.
+     *
      * @param rect The normalized rectangular area
      * @param tileLeaf Indicate the type of tile to return
      */
@@ -145,7 +154,7 @@ public:
 
     /**
      * Removes at least @p numberOfBytes bytes worth of tiles (least ranked
-     * tiles are removed first).
+     * tiles are removed first, starting with the other levels of detail).
      * Set @p visibleRect to the visible region of the page. Set a
      * @p visiblePageNumber if the current page is not visible.
      * Visible tiles are not discarded.
@@ -164,7 +173,8 @@ public:
     void setRequest(const NormalizedRect &rect, int pageWidth, int pageHeight);
 
     /**
-     * Inform the new size of the page and mark all tiles to repaint
+     * Inform the new size of the page. The current tiles are kept as a level
+     * of detail, and the tiles of a level of the new size are used again.
      */
     void setSize(int width, int height);
 
@@ -185,10 +195,15 @@ public:
     Rotation rotation() const;
 
     /**
-     * Mark all tiles as dirty
+     * Mark all tiles as dirty, in all levels of detail
      */
     void markDirty();
 
+    /**
+     * Mark the tiles intersecting with @p rect as dirty, in all levels of detail
+     */
+    void markDirty(const NormalizedRect &rect);
+
     /**
      * Returns a rotated NormalizedRect given a @p rotation
      */
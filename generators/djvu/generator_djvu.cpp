@@ -68,6 +68,7 @@ DjVuGenerator::DjVuGenerator(QObject *parent, const QVariantList &args)
 {
     setFeature(TextExtraction);
     setFeature(Threaded);
+    setFeature(TiledRendering);
     setFeature(PrintPostscript);
     if (Okular::FilePrinter::ps2pdfAvailable())
         setFeature(PrintToFile);
@@ -108,8 +109,12 @@ bool DjVuGenerator::doCloseDocument()
 
 QImage DjVuGenerator::image(Okular::PixmapRequest *request)
 {
+    QRect rect;
+    if (request->isTile())
+        rect = request->normalizedRect().geometry(request->width(), request->height());
+
     userMutex()->lock();
-    QImage img = m_djvu->image(request->pageNumber(), request->width(), request->height(), request->page()->rotation());
+    QImage img = m_djvu->image(request->pageNumber(), request->width(), request->height(), request->page()->rotation(), rect);
     userMutex()->unlock();
     return img;
 }
@@ -10,6 +10,7 @@
 #include "kdjvu.h"
 
 #include <QByteArray>
+#include <QCache>
 #include <QDomDocument>
 #include <QFile>
 #include <QHash>
@@ -135,23 +136,48 @@ static bool find_replace_or_add_second_in_pair(miniexp_t theexp, const char *whi
     return false;
 }
 
-// ImageCacheItem
+// ImageCacheKey
 
-class ImageCacheItem
+struct ImageCacheKey {
+    int page;
+    int width;
+    int height;
+    int rotation;
+    QRect rect;
+
+    bool operator==(const ImageCacheKey &other) const
+    {
+        return page == other.page && width == other.width && height == other.height && rotation == other.rotation && rect == other.rect;
+    }
+};
+
+static uint qHash(const ImageCacheKey &key, uint seed = 0)
+{
+    uint hash = ::qHash(key.page, seed);
+    for (const int value : {key.width, key.height, key.rotation, key.rect.x(), key.rect.y(), key.rect.width(), key.rect.height()})
+        hash = hash * 31 + uint(value);
+    return hash;
+}
+
+// DecodedPage
+
+class DecodedPage
 {
 public:
-    ImageCacheItem(int p, int w, int h, const QImage &i)
+    explicit DecodedPage(ddjvu_page_t *p)
         : page(p)
-        , width(w)
-        , height(h)
-        , img(i)
     {
     }
 
-    int page;
-    int width;
-    int height;
-    QImage img;
+    ~DecodedPage()
+    {
+        ddjvu_page_release(page);
+    }
+
+    DecodedPage(const DecodedPage &) = delete;
+    DecodedPage &operator=(const DecodedPage &) = delete;
+
+    ddjvu_page_t *page;
 };
 
 // KdjVu::Page
@@ -431,9 +457,11 @@ public:
         , m_docBookmarks(nullptr)
         , m_cacheEnabled(true)
     {
+        m_pages_cache.setMaxCost(maxDecodedPages);
+        mImgCache.setMaxCost(maxImageCacheCost);
     }
 
-    QImage generateImageTile(ddjvu_page_t *djvupage, int &res, int width, int row, int xdelta, int height, int col, int ydelta);
+    QImage generateImageTile(ddjvu_page_t *djvupage, int &res, int width, int height, const QRect &tile);
 
     void readBookmarks();
     void fillBookmarksRecurse(QDomDocument &maindoc, QDomNode &curnode, miniexp_t exp, int offset = -1);
@@ -447,9 +475,13 @@ public:
     ddjvu_format_t *m_format;
 
     QVector<KDjVu::Page *> m_pages;
-    QVector<ddjvu_page_t *> m_pages_cache;
+    // the decoded pages, only the most recently used ones are kept
+    QCache<int, DecodedPage> m_pages_cache;
+    static const int maxDecodedPages = 8;
 
-    QList<ImageCacheItem *> mImgCache;
+    // the rendered images, the cost is their size in bytes
+    QCache<ImageCacheKey, QImage> mImgCache;
+    static const int maxImageCacheCost = 64 * 1024 * 1024;
 
     QHash<QString, QVariant> m_metaData;
     QDomDocument *m_docBookmarks;
@@ -463,15 +495,13 @@ public:
 
 unsigned int KDjVu::Private::s_formatmask[4] = {0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000};
 
-QImage KDjVu::Private::generateImageTile(ddjvu_page_t *djvupage, int &res, int width, int row, int xdelta, int height, int col, int ydelta)
+QImage KDjVu::Private::generateImageTile(ddjvu_page_t *djvupage, int &res, int width, int height, const QRect &tile)
 {
     ddjvu_rect_t renderrect;
-    renderrect.x = row * xdelta;
-    renderrect.y = col * ydelta;
-    int realwidth = qMin(width - renderrect.x, xdelta);
-    int realheight = qMin(height - renderrect.y, ydelta);
-    renderrect.w = realwidth;
-    renderrect.h = realheight;
+    renderrect.x = tile.x();
+    renderrect.y = tile.y();
+    renderrect.w = tile.width();
+    renderrect.h = tile.height();
 #ifdef KDJVU_DEBUG
     qDebug() << "renderrect:" << renderrect;
 #endif
@@ -484,7 +514,7 @@ QImage KDjVu::Private::generateImageTile(ddjvu_page_t *djvupage, int &res, int w
     qDebug() << "pagerect:" << pagerect;
 #endif
     handle_ddjvu_messages(m_djvu_cxt, false);
-    QImage res_img(realwidth, realheight, QImage::Format_RGB32);
+    QImage res_img(tile.width(), tile.height(), QImage::Format_RGB32);
     // the following line workarounds a rare crash in djvulibre;
     // it should be fixed with >= 3.5.21
     ddjvu_page_get_width(djvupage);
@@ -657,7 +687,6 @@ bool KDjVu::openFile(const QString &fileName)
     d->m_pages.clear();
     d->m_pages.resize(numofpages);
     d->m_pages_cache.clear();
-    d->m_pages_cache.resize(numofpages);
 
     // get the document type
     QString doctype;
@@ -725,12 +754,8 @@ void KDjVu::closeFile()
     qDeleteAll(d->m_pages);
     d->m_pages.clear();
     // releasing the djvu pages
-    QVector<ddjvu_page_t *>::Iterator it = d->m_pages_cache.begin(), itEnd = d->m_pages_cache.end();
-    for (; it != itEnd; ++it)
-        ddjvu_page_release(*it);
     d->m_pages_cache.clear();
     // clearing the image cache
-    qDeleteAll(d->mImgCache);
     d->mImgCache.clear();
     // clearing the old metadata
     d->m_metaData.clear();
@@ -844,36 +869,27 @@ const QVector<KDjVu::Page *> &KDjVu::pages() const
     return d->m_pages;
 }
 
-QImage KDjVu::image(int page, int width, int height, int rotation)
+QImage KDjVu::image(int page, int width, int height, int rotation, const QRect &rect)
 {
+    const QRect pageRect(0, 0, width, height);
+    const QRect renderRect = rect.isNull() ? pageRect : rect & pageRect;
+    const ImageCacheKey key = {page, width, height, rotation, rect};
     if (d->m_cacheEnabled) {
-        bool found = false;
-        QList<ImageCacheItem *>::Iterator it = d->mImgCache.begin(), itEnd = d->mImgCache.end();
-        for (; (it != itEnd) && !found; ++it) {
-            ImageCacheItem *cur = *it;
-            if ((cur->page == page) && (rotation % 2 == 0 ? cur->width == width && cur->height == height : cur->width == height && cur->height == width))
-                found = true;
-        }
-        if (found) {
-            // taking the element and pushing to the top of the list
-            --it;
-            ImageCacheItem *cur2 = *it;
-            d->mImgCache.erase(it);
-            d->mImgCache.push_front(cur2);
-
-            return cur2->img;
-        }
+        if (const QImage *cached = d->mImgCache.object(key))
+            return *cached;
     }
 
-    if (!d->m_pages_cache.at(page)) {
+    DecodedPage *decodedPage = d->m_pages_cache.object(page);
+    if (!decodedPage) {
         ddjvu_page_t *newpage = ddjvu_page_create_by_pageno(d->m_djvu_document, page);
         // wait for the new page to be loaded
         ddjvu_status_t sts;
         while ((sts = ddjvu_page_decoding_status(newpage)) < DDJVU_JOB_OK)
             handle_ddjvu_messages(d->m_djvu_cxt, true);
-        d->m_pages_cache[page] = newpage;
+        decodedPage = new DecodedPage(newpage);
+        d->m_pages_cache.insert(page, decodedPage);
     }
-    ddjvu_page_t *djvupage = d->m_pages_cache[page];
+    ddjvu_page_t *djvupage = decodedPage->page;
 
     /*
         if ( ddjvu_page_get_rotation( djvupage ) != flipRotation( rotation ) )
@@ -887,27 +903,28 @@ QImage KDjVu::image(int page, int width, int height, int rotation)
     static const int xdelta = 1500;
     static const int ydelta = 1500;
 
-    int xparts = width / xdelta + 1;
-    int yparts = height / ydelta + 1;
+    int xparts = (renderRect.width() + xdelta - 1) / xdelta;
+    int yparts = (renderRect.height() + ydelta - 1) / ydelta;
 
     QImage newimg;
 
     int res = 10000;
-    if ((xparts == 1) && (yparts == 1)) {
+    if ((xparts <= 1) && (yparts <= 1)) {
         // only one part -- render at once with no need to auxiliary image
-        newimg = d->generateImageTile(djvupage, res, width, 0, xdelta, height, 0, ydelta);
+        newimg = d->generateImageTile(djvupage, res, width, height, renderRect);
     } else {
         // more than one part -- need to render piece-by-piece and to compose
         // the results
-        newimg = QImage(width, height, QImage::Format_RGB32);
+        newimg = QImage(renderRect.width(), renderRect.height(), QImage::Format_RGB32);
         QPainter p;
         p.begin(&newimg);
         int parts = xparts * yparts;
         for (int i = 0; i < parts; ++i) {
             const int row = i % xparts;
             const int col = i / xparts;
+            const QRect tile = QRect(renderRect.x() + row * xdelta, renderRect.y() + col * ydelta, xdelta, ydelta) & renderRect;
             int tmpres = 0;
-            const QImage tempp = d->generateImageTile(djvupage, tmpres, width, row, xdelta, height, col, ydelta);
+            const QImage tempp = d->generateImageTile(djvupage, tmpres, width, height, tile);
             p.drawImage(row * xdelta, col * ydelta, tempp);
             res = qMin(tmpres, res);
         }
@@ -915,27 +932,7 @@ QImage KDjVu::image(int page, int width, int height, int rotation)
     }
 
     if (res && d->m_cacheEnabled) {
-        // delete all the cached pixmaps for the current page with a size that
-        // differs no more than 35% of the new pixmap size
-        int imgsize = newimg.width() * newimg.height();
-        if (imgsize > 0) {
-            for (int i = 0; i < d->mImgCache.count();) {
-                ImageCacheItem *cur = d->mImgCache.at(i);
-                if ((cur->page == page) && (abs(cur->img.width() * cur->img.height() - imgsize) < imgsize * 0.35)) {
-                    d->mImgCache.removeAt(i);
-                    delete cur;
-                } else
-                    ++i;
-            }
-        }
-
-        // the image cache has too many elements, remove the last
-        if (d->mImgCache.size() >= 10) {
-            delete d->mImgCache.last();
-            d->mImgCache.removeLast();
-        }
-        ImageCacheItem *ich = new ImageCacheItem(page, width, height, newimg);
-        d->mImgCache.push_front(ich);
+        d->mImgCache.insert(key, new QImage(newimg), newimg.bytesPerLine() * newimg.height());
     }
 
     return newimg;
@@ -1043,7 +1040,6 @@ void KDjVu::setCacheEnabled(bool enable)
 
     d->m_cacheEnabled = enable;
     if (!d->m_cacheEnabled) {
-        qDeleteAll(d->mImgCache);
         d->mImgCache.clear();
     }
 }
@@ -260,9 +260,12 @@ public:
     /**
      * Check if the image for the specified \p page with the specified
      * \p width, \p height and \p rotation is already in cache, and returns
-     * it. If not, a null image is returned.
+     * it. If not, the image is rendered.
+     *
+     * If \p rect is not null, only that part of the page, in the pixel
+     * coordinates of the \p width x \p height page, is rendered.
      */
-    QImage image(int page, int width, int height, int rotation);
+    QImage image(int page, int width, int height, int rotation, const QRect &rect = QRect());
 
     /**
      * Export the currently open document as PostScript file \p fileName.
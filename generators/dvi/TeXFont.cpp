@@ -2,7 +2,43 @@
 #include <config.h>
 
 #include "TeXFont.h"
+#include "fontpool.h"
 
 TeXFont::~TeXFont()
 {
 }
+
+quint64 TeXFont::shrunkenCharacterKey(quint16 ch, const QColor &color) const
+{
+    // The resolution is kept with a precision of 1/8 dpi
+    const quint64 resolution = (quint64)(parent->displayResolution_in_dpi * 8.0 + 0.5) & 0x7fffff;
+    const quint64 hinted = parent->font_pool->getUseFontHints() ? 1 : 0;
+    return (resolution << 41) | (hinted << 40) | ((quint64)(ch & 0xff) << 32) | color.rgba();
+}
+
+bool TeXFont::restoreShrunkenCharacter(quint16 ch, const QColor &color)
+{
+    const ShrunkenCharacter *cached = shrunkenCharacterCache.object(shrunkenCharacterKey(ch, color));
+    if (cached == nullptr)
+        return false;
+
+    glyph *g = glyphtable + ch;
+    g->color = color;
+    g->shrunkenCharacter = cached->image;
+    g->x2 = cached->x2;
+    g->y2 = cached->y2;
+    return true;
+}
+
+void TeXFont::cacheShrunkenCharacter(quint16 ch)
+{
+    const glyph *g = glyphtable + ch;
+    if (g->shrunkenCharacter.isNull())
+        return;
+
+    ShrunkenCharacter *cached = new ShrunkenCharacter;
+    cached->image = g->shrunkenCharacter;
+    cached->x2 = g->x2;
+    cached->y2 = g->y2;
+    shrunkenCharacterCache.insert(shrunkenCharacterKey(ch, g->color), cached, g->shrunkenCharacter.bytesPerLine() * g->shrunkenCharacter.height());
+}
@@ -12,6 +12,8 @@
 #include "TeXFontDefinition.h"
 #include "glyph.h"
 
+#include <QCache>
+
 class TeXFont
 {
 public:
@@ -19,6 +21,7 @@ public:
     {
         parent = _parent;
         errorMessage.clear();
+        shrunkenCharacterCache.setMaxCost(maxShrunkenCharacterCacheCost);
     }
 
     virtual ~TeXFont();
@@ -44,8 +47,32 @@ public:
     QString errorMessage;
 
 protected:
+    // Sets the shrunken character of glyph 'ch' from the cache, if it
+    // was rendered before at the current resolution in that color.
+    // Returns false if it has to be rendered.
+    bool restoreShrunkenCharacter(quint16 ch, const QColor &color);
+
+    // Keeps the shrunken character just rendered for glyph 'ch', so
+    // that going back to this resolution does not render it again.
+    void cacheShrunkenCharacter(quint16 ch);
+
     glyph glyphtable[TeXFontDefinition::max_num_of_chars_in_font];
     TeXFontDefinition *parent;
+
+private:
+    struct ShrunkenCharacter {
+        QImage image;
+        short x2, y2;
+    };
+
+    quint64 shrunkenCharacterKey(quint16 ch, const QColor &color) const;
+
+    // Size of the cached shrunken characters of one font, in bytes
+    static const int maxShrunkenCharacterCacheCost = 4 * 1024 * 1024;
+
+    // Least recently used shrunken characters, keyed by character,
+    // resolution, hinting and color
+    QCache<quint64, ShrunkenCharacter> shrunkenCharacterCache;
 };
 
 #endif
@@ -151,7 +151,7 @@ glyph *TeXFont_PFB::getGlyph(quint16 ch, bool generateCharacterPixmap, const QCo
     if (fatalErrorInFontLoading == true)
         return g;
 
-    if ((generateCharacterPixmap == true) && ((g->shrunkenCharacter.isNull()) || (color != g->color))) {
+    if ((generateCharacterPixmap == true) && ((g->shrunkenCharacter.isNull()) || (color != g->color)) && !restoreShrunkenCharacter(ch, color)) {
         int error;
         unsigned int res = (unsigned int)(parent->displayResolution_in_dpi / parent->enlargement + 0.5);
         g->color = color;
@@ -263,6 +263,7 @@ glyph *TeXFont_PFB::getGlyph(quint16 ch, bool generateCharacterPixmap, const QCo
             g->x2 = -slot->bitmap_left;
             g->y2 = slot->bitmap_top;
         }
+        cacheShrunkenCharacter(ch);
     }
 
     // Load glyph width, if that hasn't been done yet.
@@ -153,7 +153,7 @@ glyph *TeXFont_PK::getGlyph(quint16 ch, bool generateCharacterPixmap, const QCol
 
     // At this point, g points to a properly loaded character. Generate
     // a smoothly scaled QPixmap if the user asks for it.
-    if ((generateCharacterPixmap == true) && ((g->shrunkenCharacter.isNull()) || (color != g->color)) && (characterBitmaps[ch]->w != 0)) {
+    if ((generateCharacterPixmap == true) && ((g->shrunkenCharacter.isNull()) || (color != g->color)) && (characterBitmaps[ch]->w != 0) && !restoreShrunkenCharacter(ch, color)) {
         g->color = color;
         double shrinkFactor = 1200 / parent->displayResolution_in_dpi;
 
@@ -301,6 +301,7 @@ glyph *TeXFont_PK::getGlyph(quint16 ch, bool generateCharacterPixmap, const QCol
         }
 
         g->shrunkenCharacter = im32;
+        cacheShrunkenCharacter(ch);
     }
     return g;
 }
@@ -14,7 +14,13 @@
 #include <KLocalizedString>
 
 #include <QApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QPainter>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTextStream>
 
 #include <cmath>
 #include <math.h>
@@ -44,6 +50,8 @@ fontPool::fontPool(bool useFontHinting)
     useFontHints = useFontHinting;
     CMperDVIunit = 0;
     extraSearchPath.clear();
+    fontLocationCacheLoaded = false;
+    fontLocationCacheChanged = false;
 
 #ifdef HAVE_FREETYPE
     // Initialize the Freetype Library
@@ -173,6 +181,7 @@ bool fontPool::areFontsLocated()
 void fontPool::locateFonts()
 {
     kpsewhichOutput.clear();
+    loadFontLocationCache();
 
     // First, we try and find those fonts which exist on disk
     // already. If virtual fonts are found, they will add new fonts to
@@ -209,6 +218,9 @@ void fontPool::locateFonts()
                         kpsewhichOutput.replace(QLatin1String("\n"), QLatin1String("<br/>"))),
                    -1);
     }
+
+    if (fontLocationCacheChanged)
+        saveFontLocationCache();
 }
 
 void fontPool::locateFonts(bool makePK, bool locateTFMonly, bool *virtualFontsFound)
@@ -218,6 +230,11 @@ void fontPool::locateFonts(bool makePK, bool locateTFMonly, bool *virtualFontsFo
     // generated. If pass == 0, enable font generation, if it was
     // enabled globally.
 
+    // Fonts that were found before do not need kpsewhich. The TFM
+    // files are a last resort and thus never remembered.
+    if (!locateTFMonly)
+        locateFontsFromCache(virtualFontsFound);
+
     // Now generate the command line for the kpsewhich
     // program. Unfortunately, this can be rather long and involved...
     QStringList kpsewhich_args;
@@ -322,6 +339,10 @@ void fontPool::locateFonts(bool makePK, bool locateTFMonly, bool *virtualFontsFo
                 qCDebug(OkularDviDebug) << "Associated " << fontp->fontname << " to " << matchingFiles.first();
 #endif
                 QString fname = matchingFiles.first();
+                if (!locateTFMonly && QFileInfo(fname).isAbsolute()) {
+                    fontLocationCache.insert(fontLocationKey(fontp->fontname), fname);
+                    fontLocationCacheChanged = true;
+                }
                 fontp->fontNameReceiver(fname);
                 fontp->flags |= TeXFontDefinition::FONT_KPSE_NAME;
                 if (fname.endsWith(QLatin1String(".vf"))) {
@@ -339,6 +360,87 @@ void fontPool::locateFonts(bool makePK, bool locateTFMonly, bool *virtualFontsFo
     delete kpsewhich_;
 }
 
+QString fontPool::fontLocationKey(const QString &fontname) const
+{
+#ifdef HAVE_FREETYPE
+    // Without FreeType the type 1 font files can't be used
+    if (FreeType_could_be_loaded)
+        return fontname + QStringLiteral(" freetype");
+#endif
+    return fontname;
+}
+
+void fontPool::locateFontsFromCache(bool *virtualFontsFound)
+{
+    bool restart;
+    do {
+        restart = false;
+        for (TeXFontDefinition *fontp : qAsConst(fontList)) {
+            if (fontp->isLocated())
+                continue;
+
+            const QString fname = fontLocationCache.value(fontLocationKey(fontp->fontname));
+            if (fname.isEmpty() || !QFile::exists(fname))
+                continue;
+
+#ifdef DEBUG_FONTPOOL
+            qCDebug(OkularDviDebug) << "Associated " << fontp->fontname << " to " << fname << " from the cache";
+#endif
+            fontp->fontNameReceiver(fname);
+            fontp->flags |= TeXFontDefinition::FONT_KPSE_NAME;
+            if (fname.endsWith(QLatin1String(".vf"))) {
+                if (virtualFontsFound != nullptr)
+                    *virtualFontsFound = true;
+                // The virtual font has most likely inserted other fonts
+                // into the fontList, start over.
+                restart = true;
+                break;
+            }
+        }
+    } while (restart);
+}
+
+void fontPool::loadFontLocationCache()
+{
+    if (fontLocationCacheLoaded)
+        return;
+    fontLocationCacheLoaded = true;
+
+    QFile file(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/okular/dvifontlocations"));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return;
+
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    QString line;
+    while (stream.readLineInto(&line)) {
+        const int separator = line.indexOf(QLatin1Char('\t'));
+        if (separator > 0)
+            fontLocationCache.insert(line.left(separator), line.mid(separator + 1));
+    }
+}
+
+void fontPool::saveFontLocationCache()
+{
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/okular");
+    if (!QDir().mkpath(cacheDir))
+        return;
+
+    QSaveFile file(cacheDir + QStringLiteral("/dvifontlocations"));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return;
+
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    QHash<QString, QString>::const_iterator it = fontLocationCache.constBegin();
+    for (; it != fontLocationCache.constEnd(); ++it)
+        stream << it.key() << QLatin1Char('\t') << it.value() << QLatin1Char('\n');
+    stream.flush();
+
+    if (file.commit())
+        fontLocationCacheChanged = false;
+}
+
 void fontPool::setCMperDVIunit(double _CMperDVI)
 {
 #ifdef DEBUG_FONTPOOL
@@ -11,6 +11,7 @@
 #include "fontEncodingPool.h"
 #include "fontMap.h"
 
+#include <QHash>
 #include <QList>
 #include <QObject>
 #include <QProcess>
@@ -207,6 +208,25 @@ private:
     // The handle on the external process.
     QProcess *kpsewhich_;
 
+    /** Members used to remember font locations across sessions */
+
+    // Font file names found by kpsewhich, by TeX font name. They are
+    // kept on disk, so that reopening a document or opening another
+    // one using the same fonts does not need to run kpsewhich again.
+    QHash<QString, QString> fontLocationCache;
+    bool fontLocationCacheLoaded;
+    bool fontLocationCacheChanged;
+
+    // Key of the font in the fontLocationCache
+    QString fontLocationKey(const QString &fontname) const;
+
+    // Associates the fonts that are not located yet with the file names
+    // found in earlier runs of kpsewhich, if these files still exist.
+    void locateFontsFromCache(bool *virtualFontsFound);
+
+    void loadFontLocationCache();
+    void saveFontLocationCache();
+
 private Q_SLOTS:
     // This slot is called when MetaFont is run via the kpsewhich program.
     // The MetaFont output is transmitted to the fontpool via the @c kpsewhich_
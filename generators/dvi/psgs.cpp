@@ -17,6 +17,7 @@
 
 #include <KLocalizedString>
 #include <KProcess>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 #include <QUrl>
 
@@ -55,6 +56,8 @@ ghostscript_interface::ghostscript_interface()
     knownDevices.append(QStringLiteral("pnn"));
     knownDevices.append(QStringLiteral("pnnraw"));
     gsDevice = knownDevices.begin();
+
+    graphicsCache.setMaxCost(maxGraphicsCacheCost);
 }
 
 ghostscript_interface::~ghostscript_interface()
@@ -78,6 +81,8 @@ void ghostscript_interface::setPostScript(const PageNumber page, const QString &
         pageList.insert(page, info);
     } else
         *(pageList.value(page)->PostScriptString) = PostScript;
+
+    graphicsCache.remove(page);
 }
 
 void ghostscript_interface::setIncludePath(const QString &_includePath)
@@ -144,23 +149,35 @@ void ghostscript_interface::clear()
     // Deletes all items, removes temporary files, etc.
     qDeleteAll(pageList);
     pageList.clear();
+    graphicsCache.clear();
+}
+
+pageGraphics *ghostscript_interface::cachedGraphics(const PageNumber page, long magnification) const
+{
+    pageGraphics *graphics = graphicsCache.object(page);
+    if (graphics == nullptr)
+        return nullptr;
+
+    if (graphics->resolution != resolution || graphics->magnification != magnification || graphics->image.width() != pixel_page_w || graphics->image.height() != pixel_page_h ||
+        graphics->background != getBackgroundColor(page))
+        return nullptr;
+
+    return graphics;
 }
 
-void ghostscript_interface::gs_generate_graphics_file(const PageNumber page, const QString &filename, long magnification)
+QImage ghostscript_interface::gs_generate_graphics_files(const QList<PageNumber> &pages, long magnification)
 {
 #ifdef DEBUG_PSGS
-    qCDebug(OkularDviDebug) << "ghostscript_interface::gs_generate_graphics_file( " << page << ", " << filename << " )";
+    qCDebug(OkularDviDebug) << "ghostscript_interface::gs_generate_graphics_files( " << pages << " )";
 #endif
 
     if (knownDevices.isEmpty()) {
         qCCritical(OkularDviDebug) << "No known devices found" << endl;
-        return;
+        return QImage();
     }
 
-    pageInfo *info = pageList.value(page);
-
-    // Generate a PNG-file
-    // Step 1: Write the PostScriptString to a File
+    // Generate one image file per page
+    // Step 1: Write the PostScriptStrings of all pages to a File
     QTemporaryFile PSfile(QDir::tempPath() + QLatin1String("/okular_XXXXXX.ps"));
     PSfile.setAutoRemove(false);
     PSfile.open();
@@ -170,7 +187,7 @@ void ghostscript_interface::gs_generate_graphics_file(const PageNumber page, con
     os << "%!PS-Adobe-2.0\n"
        << "%%Creator: kdvi\n"
        << "%%Title: KDVI temporary PostScript\n"
-       << "%%Pages: 1\n"
+       << "%%Pages: " << pages.count() << '\n'
        << "%%PageOrder: Ascend\n"
        // HSize and VSize in 1/72 inch
        << "%%BoundingBox: 0 0 " << (qint32)(72 * (pixel_page_w / resolution)) << ' ' << (qint32)(72 * (pixel_page_h / resolution)) << '\n'
@@ -190,36 +207,53 @@ void ghostscript_interface::gs_generate_graphics_file(const PageNumber page, con
        << " 300 300"
        // Name
        << " (test.dvi)"
-       << " @start end\n"
-       << "TeXDict begin\n"
-       // Start page
-       << "1 0 bop 0 0 a \n";
+       << " @start end\n";
 
-    if (!PostScriptHeaderString->toLatin1().isNull())
-        os << PostScriptHeaderString->toLatin1();
+    for (const PageNumber &page : pages) {
+        pageInfo *info = pageList.value(page);
 
-    if (info->background != Qt::white) {
-        QString colorCommand = QStringLiteral("gsave %1 %2 %3 setrgbcolor clippath fill grestore\n").arg(info->background.red() / 255.0).arg(info->background.green() / 255.0).arg(info->background.blue() / 255.0);
-        os << colorCommand.toLatin1();
-    }
+        // Save and restore the state around each page, so that the
+        // PostScript of one page cannot change the graphics of the
+        // following ones.
+        os << "save\n"
+           << "TeXDict begin\n"
+           // Start page
+           << "1 0 bop 0 0 a \n";
 
-    if (!info->PostScriptString->isNull())
-        os << *(info->PostScriptString);
+        if (!PostScriptHeaderString->toLatin1().isNull())
+            os << PostScriptHeaderString->toLatin1();
 
-    os << "end\n"
-       << "showpage \n";
+        if (info->background != Qt::white) {
+            QString colorCommand = QStringLiteral("gsave %1 %2 %3 setrgbcolor clippath fill grestore\n").arg(info->background.red() / 255.0).arg(info->background.green() / 255.0).arg(info->background.blue() / 255.0);
+            os << colorCommand.toLatin1();
+        }
+
+        if (!info->PostScriptString->isNull())
+            os << *(info->PostScriptString);
+
+        os << "end\n"
+           << "showpage \n"
+           << "restore\n";
+    }
 
     PSfile.close();
 
-    // Step 2: Call GS with the File
-    QFile::remove(filename);
+    // Step 2: Call GS with the File. Ghostscript numbers the output
+    // files of the pages, starting at 1.
+    QTemporaryDir outputDir;
+    if (!outputDir.isValid()) {
+        qCCritical(OkularDviDebug) << "Could not create a temporary directory for the output of GS." << endl;
+        PSfile.remove();
+        return QImage();
+    }
+    const QString outputPattern = outputDir.path() + QStringLiteral("/%d");
     KProcess proc;
     proc.setOutputChannelMode(KProcess::SeparateChannels);
     QStringList argus;
     argus << QStringLiteral("gs");
     argus << QStringLiteral("-dSAFER") << QStringLiteral("-dPARANOIDSAFER") << QStringLiteral("-dDELAYSAFER") << QStringLiteral("-dNOPAUSE") << QStringLiteral("-dBATCH");
     argus << QStringLiteral("-sDEVICE=%1").arg(*gsDevice);
-    argus << QStringLiteral("-sOutputFile=%1").arg(filename);
+    argus << QStringLiteral("-sOutputFile=%1").arg(outputPattern);
     argus << QStringLiteral("-sExtraIncludePath=%1").arg(includePath);
     argus << QStringLiteral("-g%1x%2").arg(pixel_page_w).arg(pixel_page_h); // page size in pixels
     argus << QStringLiteral("-r%1").arg(resolution);                        // resolution in dpi
@@ -242,8 +276,27 @@ void ghostscript_interface::gs_generate_graphics_file(const PageNumber page, con
 
     PSfile.remove();
 
+    // Step 3: Read the files produced by gs
+    bool producedOutput = false;
+    QImage firstImage;
+    for (int i = 0; i < pages.count(); ++i) {
+        pageGraphics *graphics = new pageGraphics;
+        graphics->image = QImage(outputDir.path() + QStringLiteral("/%1").arg(i + 1));
+        if (graphics->image.isNull()) {
+            delete graphics;
+            continue;
+        }
+        producedOutput = true;
+        if (i == 0)
+            firstImage = graphics->image;
+        graphics->resolution = resolution;
+        graphics->magnification = magnification;
+        graphics->background = getBackgroundColor(pages[i]);
+        graphicsCache.insert(pages[i], graphics, graphics->image.bytesPerLine() * graphics->image.height());
+    }
+
     // Check if gs has indeed produced a file.
-    if (QFile::exists(filename) == false) {
+    if (producedOutput == false) {
         qCCritical(OkularDviDebug) << "GS did not produce output." << endl;
 
         // No. Check is the reason is that the device is not compiled into
@@ -286,12 +339,14 @@ void ghostscript_interface::gs_generate_graphics_file(const PageNumber page, con
 #endif
                 else {
                     qCDebug(OkularDviDebug) << QStringLiteral("Okular will now try to use the '%1' device driver.").arg(*gsDevice);
-                    gs_generate_graphics_file(page, filename, magnification);
+                    return gs_generate_graphics_files(pages, magnification);
                 }
-                return;
+                return QImage();
             }
         }
     }
+
+    return firstImage;
 }
 
 void ghostscript_interface::graphics(const PageNumber page, double dpi, long magnification, QPainter *paint)
@@ -320,16 +375,29 @@ void ghostscript_interface::graphics(const PageNumber page, double dpi, long mag
         return;
     }
 
-    QTemporaryFile gfxFile;
-    gfxFile.open();
-    const QString gfxFileName = gfxFile.fileName();
-    // We are want the filename, not the file.
-    gfxFile.close();
+    QImage image;
+    pageGraphics *graphics = cachedGraphics(page, magnification);
+    if (graphics != nullptr) {
+        image = graphics->image;
+    } else {
+        // Render the graphics of the next few pages in the same
+        // ghostscript run, they are likely to be needed soon.
+        quint16 lastPage = page;
+        for (QHash<quint16, pageInfo *>::const_iterator it = pageList.constBegin(); it != pageList.constEnd(); ++it)
+            lastPage = qMax(lastPage, it.key());
+
+        QList<PageNumber> pages;
+        pages << page;
+        for (quint16 nextPage = page + 1; pages.count() < maxPagesPerGhostscriptRun && nextPage > page && nextPage <= lastPage; ++nextPage) {
+            pageInfo *nextInfo = pageList.value(nextPage);
+            if ((nextInfo != nullptr) && !nextInfo->PostScriptString->isEmpty() && (cachedGraphics(nextPage, magnification) == nullptr))
+                pages << nextPage;
+        }
 
-    gs_generate_graphics_file(page, gfxFileName, magnification);
+        image = gs_generate_graphics_files(pages, magnification);
+    }
 
-    QImage MemoryCopy(gfxFileName);
-    paint->drawImage(0, 0, MemoryCopy);
+    paint->drawImage(0, 0, image);
     return;
 }
 
@@ -11,9 +11,11 @@
 #define _PSGS_H_
 
 #include <QApplication>
+#include <QCache>
 #include <QColor>
 #include <QEvent>
 #include <QHash>
+#include <QImage>
 #include <QObject>
 
 class QUrl;
@@ -34,6 +36,17 @@ public:
     QString *PostScriptString;
 };
 
+// The graphics of a page, as produced by ghostscript, together with
+// the parameters that were used to produce them.
+class pageGraphics
+{
+public:
+    QImage image;
+    double resolution;
+    long magnification;
+    QColor background;
+};
+
 class ghostscript_interface : public QObject
 {
     Q_OBJECT
@@ -80,9 +93,28 @@ public:
     static QString locateEPSfile(const QString &filename, const QUrl &base);
 
 private:
-    void gs_generate_graphics_file(const PageNumber page, const QString &filename, long magnification);
+    // Runs ghostscript once to produce the graphics of all the pages,
+    // and stores them in the graphicsCache. Returns the graphics of the
+    // first page, which may be too large to be cached.
+    QImage gs_generate_graphics_files(const QList<PageNumber> &pages, long magnification);
+
+    // Returns the cached graphics of the page if they were produced
+    // with the current resolution, page size, magnification and
+    // background color. Returns 0 otherwise.
+    pageGraphics *cachedGraphics(const PageNumber page, long magnification) const;
+
     QHash<quint16, pageInfo *> pageList;
 
+    // Graphics already produced by ghostscript, by page number. The
+    // cost of an entry is the size of its image in bytes.
+    QCache<quint16, pageGraphics> graphicsCache;
+    static const int maxGraphicsCacheCost = 64 * 1024 * 1024;
+
+    // Starting ghostscript takes much longer than rendering most
+    // graphics, so the pages following the requested one are
+    // rendered in the same run.
+    static const int maxPagesPerGhostscriptRun = 4;
+
     double resolution; // in dots per inch
     int pixel_page_w;  // in pixels
     int pixel_page_h;  // in pixels
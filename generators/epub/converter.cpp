@@ -223,6 +223,24 @@ QTextDocument *Converter::convert(const QString &fileName)
         const int maxWidth = mTextDocument->maxContentWidth();
         QDomDocument dom;
         if (dom.setContent(htmlContent)) {
+            // let the layout take the image sizes from the image headers, the pixels
+            // are only decoded once a page showing them gets rendered
+            QDomNodeList imgs = dom.elementsByTagName(QStringLiteral("img"));
+            for (int i = 0; i < imgs.length(); ++i) {
+                QDomElement imgElement = imgs.at(i).toElement();
+                QSize imgSize;
+                const QString lnk = mTextDocument->deferImage(imgElement.attribute(QStringLiteral("src")), &imgSize);
+                if (lnk.isEmpty())
+                    continue;
+
+                imgElement.setAttribute(QStringLiteral("src"), lnk);
+                if (!imgElement.hasAttribute(QStringLiteral("width")) && !imgElement.hasAttribute(QStringLiteral("height"))) {
+                    imgSize = mTextDocument->boundedImageSize(imgSize);
+                    imgElement.setAttribute(QStringLiteral("width"), imgSize.width());
+                    imgElement.setAttribute(QStringLiteral("height"), imgSize.height());
+                }
+            }
+
             QDomNodeList svgs = dom.elementsByTagName(QStringLiteral("svg"));
             if (!svgs.isEmpty()) {
                 QList<QDomNode> imgNodes;
@@ -232,16 +250,24 @@ QTextDocument *Converter::convert(const QString &fileName)
                         QString lnk = images.at(i).toElement().attribute(QStringLiteral("xlink:href"));
                         int ht = images.at(i).toElement().attribute(QStringLiteral("height")).toInt();
                         int wd = images.at(i).toElement().attribute(QStringLiteral("width")).toInt();
-                        QImage img = mTextDocument->loadResource(QTextDocument::ImageResource, QUrl(lnk)).value<QImage>();
+                        QSize imgSize;
+                        const QString deferredLnk = mTextDocument->deferImage(lnk, &imgSize);
+                        if (deferredLnk.isEmpty()) {
+                            const QImage img = mTextDocument->loadResource(QTextDocument::ImageResource, QUrl(lnk)).value<QImage>();
+                            mTextDocument->addResource(QTextDocument::ImageResource, QUrl(lnk), img);
+                            imgSize = img.size();
+                        } else {
+                            lnk = deferredLnk;
+                            imgSize = mTextDocument->boundedImageSize(imgSize);
+                        }
                         if (ht == 0)
-                            ht = img.height();
+                            ht = imgSize.height();
                         if (wd == 0)
-                            wd = img.width();
+                            wd = imgSize.width();
                         if (ht > maxHeight)
                             ht = maxHeight;
                         if (wd > maxWidth)
                             wd = maxWidth;
-                        mTextDocument->addResource(QTextDocument::ImageResource, QUrl(lnk), img);
                         QDomDocument newDoc;
                         newDoc.setContent(QStringLiteral("<img src=\"%1\" height=\"%2\" width=\"%3\" />").arg(lnk).arg(ht).arg(wd));
                         imgNodes.append(newDoc.documentElement());
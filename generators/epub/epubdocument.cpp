@@ -8,7 +8,9 @@
  ***************************************************************************/
 
 #include "epubdocument.h"
+#include <QBuffer>
 #include <QDir>
+#include <QImageReader>
 #include <QTemporaryFile>
 
 #include <QRegExp>
@@ -62,6 +64,61 @@ int EpubDocument::maxContentWidth() const
     return pageSize().width() - (2 * padding);
 }
 
+QSize EpubDocument::boundedImageSize(const QSize &size) const
+{
+    QSize result = size;
+    const int maxHeight = maxContentHeight();
+    const int maxWidth = maxContentWidth();
+    if (result.height() > maxHeight)
+        result = QSize(qMax(1, qRound(result.width() * (qreal)maxHeight / result.height())), maxHeight);
+    if (result.width() > maxWidth)
+        result = QSize(maxWidth, qMax(1, qRound(result.height() * (qreal)maxWidth / result.width())));
+    return result;
+}
+
+QByteArray EpubDocument::resourceData(const QString &path) const
+{
+    char *data = nullptr;
+    const int size = epub_get_data(mEpub, path.toUtf8().constData(), &data);
+
+    QByteArray result;
+    if (data) {
+        result = QByteArray(data, size);
+        free(data);
+    }
+    return result;
+}
+
+/**
+ * Registers the image @p link of the current sub document for deferred decoding.
+ *
+ * Only the image header is read to get its intrinsic @p size, the pixels are
+ * decoded by loadResource() the first time the page showing it is painted.
+ * Returns the link the image has to be referenced with from now on, or an
+ * empty string if the size could not be determined.
+ */
+QString EpubDocument::deferImage(const QString &link, QSize *size)
+{
+    const QString path = mCurrentSubDocument.resolved(QUrl(link)).path();
+
+    QSize imageSize = mDeferredImages.value(path);
+    if (!imageSize.isValid()) {
+        QByteArray data = resourceData(path);
+        QBuffer buffer(&data);
+        QImageReader reader(&buffer);
+        imageSize = reader.size();
+        if (!imageSize.isValid())
+            return QString();
+        mDeferredImages.insert(path, imageSize);
+    }
+    *size = imageSize;
+
+    // the resolved path must not depend on the sub document current at paint time
+    QUrl url;
+    url.setPath(path);
+    return url.toString();
+}
+
 void EpubDocument::checkCSS(QString &css)
 {
     // remove paragraph line-heights
@@ -74,6 +131,8 @@ QVariant EpubDocument::loadResource(int type, const QUrl &name)
     char *data;
 
     QString fileInPath = mCurrentSubDocument.resolved(name).path();
+    if (type == QTextDocument::ImageResource && mDeferredImages.contains(name.path()))
+        fileInPath = name.path();
 
     // Get the data from the epub file
     size = epub_get_data(mEpub, fileInPath.toUtf8().constData(), &data);
@@ -83,14 +142,17 @@ QVariant EpubDocument::loadResource(int type, const QUrl &name)
     if (data) {
         switch (type) {
         case QTextDocument::ImageResource: {
-            QImage img = QImage::fromData((unsigned char *)data, size);
-            const int maxHeight = maxContentHeight();
-            const int maxWidth = maxContentWidth();
-            if (img.height() > maxHeight)
-                img = img.scaledToHeight(maxHeight, Qt::SmoothTransformation);
-            if (img.width() > maxWidth)
-                img = img.scaledToWidth(maxWidth, Qt::SmoothTransformation);
-            resource.setValue(img);
+            // decode straight at the size it is going to be displayed at
+            QByteArray imageData = QByteArray::fromRawData(data, size);
+            QBuffer buffer(&imageData);
+            QImageReader reader(&buffer);
+            const QSize imageSize = reader.size();
+            if (imageSize.isValid()) {
+                const QSize displaySize = boundedImageSize(imageSize);
+                if (displaySize != imageSize)
+                    reader.setScaledSize(displaySize);
+            }
+            resource.setValue(reader.read());
             break;
         }
         case QTextDocument::StyleSheetResource: {
@@ -10,6 +10,7 @@
 #ifndef EPUB_DOCUMENT_H
 #define EPUB_DOCUMENT_H
 
+#include <QHash>
 #include <QImage>
 #include <QLoggingCategory>
 #include <QTextDocument>
@@ -31,6 +32,8 @@ public:
     void setCurrentSubDocument(const QString &doc);
     int maxContentHeight() const;
     int maxContentWidth() const;
+    QSize boundedImageSize(const QSize &size) const;
+    QString deferImage(const QString &link, QSize *size);
     enum Multimedia { MovieResource = QTextDocument::UserResource, AudioResource };
 
 protected:
@@ -38,9 +41,12 @@ protected:
 
 private:
     void checkCSS(QString &css);
+    QByteArray resourceData(const QString &path) const;
 
     struct epub *mEpub;
     QUrl mCurrentSubDocument;
+    // archive path -> intrinsic size of the images whose decoding is deferred until painted
+    QHash<QString, QSize> mDeferredImages;
 
     int padding;
 
@@ -20,6 +20,9 @@ OKULAR_EXPORT_PLUGIN(EPubGenerator, "libokularGenerator_epub.json")
 EPubGenerator::EPubGenerator(QObject *parent, const QVariantList &args)
     : Okular::TextDocumentGenerator(new Epub::Converter, QStringLiteral("okular_epub_generator_settings"), parent, args)
 {
+    // the converter changes the palette of the application, which can only
+    // be done from the GUI thread
+    setFeature(AsynchronousLoading, false);
 }
 
 EPubGenerator::~EPubGenerator()
@@ -0,0 +1,82 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by The Okular Developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "bilevelimage.h"
+
+#include <QRect>
+#include <QVector>
+#include <QtAlgorithms>
+
+#include <string.h>
+
+namespace BilevelImage
+{
+int countPixels(const uchar *line, int from, int to)
+{
+    const int firstByte = from / 8;
+    const int lastByte = (to - 1) / 8;
+    const uchar firstMask = 0xff << (from % 8);
+    const uchar lastMask = 0xff >> (7 - (to - 1) % 8);
+
+    if (firstByte == lastByte)
+        return qPopulationCount(quint8(line[firstByte] & firstMask & lastMask));
+
+    int count = qPopulationCount(quint8(line[firstByte] & firstMask));
+    int i = firstByte + 1;
+    for (; i + 8 <= lastByte; i += 8) {
+        quint64 bits;
+        memcpy(&bits, line + i, sizeof(bits));
+        count += qPopulationCount(bits);
+    }
+    for (; i < lastByte; ++i)
+        count += qPopulationCount(quint8(line[i]));
+    count += qPopulationCount(quint8(line[lastByte] & lastMask));
+
+    return count;
+}
+
+QImage scaled(const QImage &image, int width, int height, const QRect &rect)
+{
+    QImage result(rect.size(), QImage::Format_RGB32);
+    if (image.isNull() || result.isNull())
+        return result;
+
+    const int imageWidth = image.width();
+    const int imageHeight = image.height();
+    const bool blackIsSet = qGray(image.color(1)) < qGray(image.color(0));
+
+    // the column of the image where each column of the result starts
+    QVector<int> columns(rect.width() + 1);
+    for (int x = 0; x <= rect.width(); ++x)
+        columns[x] = qMin<qint64>(imageWidth, (qint64)(rect.x() + x) * imageWidth / width);
+
+    for (int y = 0; y < rect.height(); ++y) {
+        const int y0 = qMin<qint64>(imageHeight - 1, (qint64)(rect.y() + y) * imageHeight / height);
+        const int y1 = qBound<qint64>(y0 + 1, (qint64)(rect.y() + y + 1) * imageHeight / height, imageHeight);
+
+        QRgb *dest = reinterpret_cast<QRgb *>(result.scanLine(y));
+        for (int x = 0; x < rect.width(); ++x) {
+            const int x0 = qMin(columns.at(x), imageWidth - 1);
+            const int x1 = qBound(x0 + 1, columns.at(x + 1), imageWidth);
+            const int area = (x1 - x0) * (y1 - y0);
+
+            int set = 0;
+            for (int line = y0; line < y1; ++line)
+                set += countPixels(image.constScanLine(line), x0, x1);
+
+            const int black = blackIsSet ? set : area - set;
+            const int gray = 255 - black * 255 / area;
+            dest[x] = qRgb(gray, gray, gray);
+        }
+    }
+
+    return result;
+}
+
+}
@@ -0,0 +1,37 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by The Okular Developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef BILEVELIMAGE_H
+#define BILEVELIMAGE_H
+
+#include <QImage>
+
+class QRect;
+
+/**
+ * Scaling of bilevel images, such as faxes, that works on their bits instead
+ * of converting them to 32 bits per pixel at full resolution first.
+ */
+namespace BilevelImage
+{
+/**
+ * Counts the set pixels in [@p from, @p to) of a QImage::Format_MonoLSB scanline.
+ */
+int countPixels(const uchar *line, int from, int to);
+
+/**
+ * Renders the part @p rect of the QImage::Format_MonoLSB @p image scaled to
+ * @p width x @p height. Each pixel gets the gray of the fraction of black
+ * pixels in the box of the image it covers.
+ */
+QImage scaled(const QImage &image, int width, int height, const QRect &rect);
+
+}
+
+#endif
@@ -59,7 +59,7 @@ static bool new_image(pagenode *pn, int width, int height)
     pn->image.setColor(1, qRgb(0, 0, 0));
     pn->bytes_per_line = pn->image.bytesPerLine();
     pn->dpi = FAX_DPI_FINE;
-    pn->imageData = new uchar[width * height];
+    pn->imageData = new uchar[pn->bytes_per_line * height];
 
     return !pn->image.isNull();
 }
@@ -284,7 +284,8 @@ bool FaxDocument::load()
     img.setColor(0, qRgb(255, 255, 255));
     img.setColor(1, qRgb(0, 0, 0));
 
-    d->mPageNode.image = img.copy().scaled(img.width(), img.height() * 1.5);
+    // keep one bit per pixel, the generator renders from it directly
+    d->mPageNode.image = img.copy().scaled(img.width(), img.height() * 1.5).convertToFormat(QImage::Format_MonoLSB);
 
     return true;
 }
@@ -51,7 +51,7 @@ public:
     bool load();
 
     /**
-     * Returns the document as an image.
+     * Returns the document as a bilevel image, in QImage::Format_MonoLSB.
      */
     QImage image() const;
 
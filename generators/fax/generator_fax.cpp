@@ -18,12 +18,15 @@
 #include <core/document.h>
 #include <core/page.h>
 
+#include "bilevelimage.h"
+
 OKULAR_EXPORT_PLUGIN(FaxGenerator, "libokularGenerator_fax.json")
 
 FaxGenerator::FaxGenerator(QObject *parent, const QVariantList &args)
     : Generator(parent, args)
 {
     setFeature(Threaded);
+    setFeature(TiledRendering);
     setFeature(PrintNative);
     setFeature(PrintToFile);
 }
@@ -65,13 +68,18 @@ bool FaxGenerator::doCloseDocument()
 
 QImage FaxGenerator::image(Okular::PixmapRequest *request)
 {
-    // perform a smooth scaled generation
     int width = request->width();
     int height = request->height();
-    if (request->page()->rotation() % 2 == 1)
-        qSwap(width, height);
+    QRect rect;
+    if (request->isTile()) {
+        rect = request->normalizedRect().geometry(width, height);
+    } else {
+        if (request->page()->rotation() % 2 == 1)
+            qSwap(width, height);
+        rect = QRect(0, 0, width, height);
+    }
 
-    return m_img.scaled(width, height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    return BilevelImage::scaled(m_img, width, height, rect);
 }
 
 Okular::DocumentInfo FaxGenerator::generateDocumentInfo(const QSet<Okular::DocumentInfo::Key> &keys) const
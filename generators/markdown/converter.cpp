@@ -11,7 +11,11 @@
 
 #include <KLocalizedString>
 
+#include <QCryptographicHash>
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
 #include <QTextCursor>
 #include <QTextDocument>
 #include <QTextFrame>
@@ -61,6 +65,9 @@ Converter::~Converter()
 
 QTextDocument *Converter::convert(const QString &fileName)
 {
+    if (m_markdownFile) {
+        fclose(m_markdownFile);
+    }
     m_markdownFile = fopen(fileName.toLocal8Bit(), "rb");
     if (!m_markdownFile) {
         emit error(i18n("Failed to open the document"), -1);
@@ -93,24 +100,146 @@ void Converter::convertAgain()
     setDocument(convertOpenFile());
 }
 
+// Returns the number of times the HTML tag @p tag is opened in the lowercase @p line,
+// minus the number of times it is closed
+static int htmlTagDepth(const QByteArray &line, const QByteArray &tag)
+{
+    int depth = 0;
+    for (int i = line.indexOf('<'); i != -1; i = line.indexOf('<', i + 1)) {
+        const bool closing = line.mid(i + 1, 1) == "/";
+        const int nameStart = closing ? i + 2 : i + 1;
+        if (line.mid(nameStart, tag.size()) != tag)
+            continue;
+        const char after = nameStart + tag.size() < line.size() ? line.at(nameStart + tag.size()) : '\n';
+        if (after == '>' || after == ' ' || after == '\t' || after == '\n' || after == '\r' || (after == '/' && !closing))
+            depth += closing ? -1 : 1;
+    }
+    return depth;
+}
+
+// Splits the Markdown source in sections, before the ATX headings that follow a blank line
+// outside of fenced code blocks and raw HTML blocks. The reference definitions are collected
+// in @p references, they are needed to convert any of the sections.
+static QList<QByteArray> splitSections(const QByteArray &source, QByteArray &references)
+{
+    // the tags that start a raw HTML block when they open a line, as discount knows them
+    static const QList<QByteArray> blockTags = {"address", "article", "aside", "blockquote", "center", "del", "details", "dir", "div", "dl", "fieldset", "figure", "footer", "form", "h1", "h2", "h3", "h4", "h5", "h6",
+                                                "header", "iframe", "ins", "map", "menu", "nav", "noscript", "object", "ol", "p", "pre", "script", "section", "style", "table", "ul", "video"};
+
+    QList<QByteArray> sections;
+    int sectionStart = 0;
+    // the opening fence of the fenced code block we are in, if any
+    QByteArray fence;
+    // the tag of the raw HTML block we are in and how deep, if any
+    QByteArray htmlTag;
+    int htmlDepth = 0;
+    bool inHtmlComment = false;
+    bool previousLineBlank = true;
+
+    int lineStart = 0;
+    while (lineStart < source.size()) {
+        int lineEnd = source.indexOf('\n', lineStart);
+        if (lineEnd == -1)
+            lineEnd = source.size() - 1;
+        const QByteArray line = source.mid(lineStart, lineEnd - lineStart + 1);
+        const QByteArray trimmedLine = line.trimmed();
+        int indentation = 0;
+        while (indentation < line.size() && line.at(indentation) == ' ')
+            ++indentation;
+
+        if (!fence.isEmpty()) {
+            // only a fence of the same character, at least as long and without info string closes the block
+            int fenceLength = 0;
+            while (fenceLength < trimmedLine.size() && trimmedLine.at(fenceLength) == fence.at(0))
+                ++fenceLength;
+            if (indentation < 4 && fenceLength >= fence.size() && fenceLength == trimmedLine.size())
+                fence.clear();
+        } else if (inHtmlComment) {
+            inHtmlComment = !line.contains("-->");
+        } else if (!htmlTag.isEmpty()) {
+            htmlDepth += htmlTagDepth(line.toLower(), htmlTag);
+            if (htmlDepth <= 0)
+                htmlTag.clear();
+        } else if (indentation < 4 && (trimmedLine.startsWith("```") || trimmedLine.startsWith("~~~"))) {
+            int fenceLength = 0;
+            while (fenceLength < trimmedLine.size() && trimmedLine.at(fenceLength) == trimmedLine.at(0))
+                ++fenceLength;
+            fence = trimmedLine.left(fenceLength);
+        } else if (line.startsWith("<!--")) {
+            inHtmlComment = !line.contains("-->");
+        } else if (line.startsWith('<')) {
+            const QByteArray lowerLine = line.toLower();
+            for (const QByteArray &tag : blockTags) {
+                const int depth = htmlTagDepth(lowerLine, tag);
+                if (lowerLine.mid(1, tag.size()) == tag && depth > 0) {
+                    htmlTag = tag;
+                    htmlDepth = depth;
+                    break;
+                }
+            }
+        } else if (line.startsWith('#') && previousLineBlank && lineStart > sectionStart) {
+            sections << source.mid(sectionStart, lineStart - sectionStart);
+            sectionStart = lineStart;
+        } else if (indentation < 4 && trimmedLine.startsWith('[') && trimmedLine.contains("]:")) {
+            references += line;
+        }
+
+        previousLineBlank = trimmedLine.isEmpty();
+        lineStart = lineEnd + 1;
+    }
+
+    if (sectionStart < source.size())
+        sections << source.mid(sectionStart);
+
+    return sections;
+}
+
 QTextDocument *Converter::convertOpenFile()
 {
     rewind(m_markdownFile);
 
-    MMIOT *markdownHandle = mkd_in(m_markdownFile, 0);
+    QFile markdownFile;
+    if (!markdownFile.open(m_markdownFile, QIODevice::ReadOnly)) {
+        emit error(i18n("Failed to open the document"), -1);
+        return nullptr;
+    }
+    const QByteArray source = markdownFile.readAll();
 
     int flags = MKD_FENCEDCODE | MKD_GITHUBTAGS | MKD_AUTOLINK | MKD_TOC | MKD_IDANCHOR;
     if (!m_isFancyPantsEnabled)
         flags |= MKD_NOPANTS;
-    if (!mkd_compile(markdownHandle, flags)) {
-        emit error(i18n("Failed to compile the Markdown document."), -1);
-        return nullptr;
-    }
 
-    char *htmlDocument;
-    const int size = mkd_document(markdownHandle, &htmlDocument);
+    QByteArray references;
+    const QList<QByteArray> sections = splitSections(source, references);
+    if (!references.isEmpty())
+        references.prepend("\n\n");
+
+    QString html;
+    QHash<QByteArray, QString> sectionsHtml;
+    int convertedSections = 0;
+    for (const QByteArray &section : sections) {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(QByteArray::number(flags));
+        hash.addData(section);
+        hash.addData(references);
+        const QByteArray key = hash.result();
+
+        QString sectionHtml;
+        if (m_sectionsHtml.contains(key)) {
+            sectionHtml = m_sectionsHtml.value(key);
+        } else if (sectionsHtml.contains(key)) {
+            sectionHtml = sectionsHtml.value(key);
+        } else {
+            if (!convertSection(section + references, flags, sectionHtml))
+                return nullptr;
+            ++convertedSections;
+        }
 
-    const QString html = QString::fromUtf8(htmlDocument, size);
+        sectionsHtml.insert(key, sectionHtml);
+        html += sectionHtml + QLatin1Char('\n');
+    }
+    m_sectionsHtml = sectionsHtml;
+    qCDebug(OkularMdDebug) << "Converted" << convertedSections << "of" << sections.count() << "sections";
 
     QTextDocument *textDocument = new QTextDocument;
     textDocument->setPageSize(QSizeF(PAGE_WIDTH, PAGE_HEIGHT));
@@ -118,8 +247,6 @@ QTextDocument *Converter::convertOpenFile()
     if (generator())
         textDocument->setDefaultFont(generator()->generalSettings()->font());
 
-    mkd_cleanup(markdownHandle);
-
     QTextFrameFormat frameFormat;
     frameFormat.setMargin(PAGE_MARGIN);
 
@@ -131,6 +258,43 @@ QTextDocument *Converter::convertOpenFile()
     return textDocument;
 }
 
+bool Converter::convertSection(QByteArray markdown, int flags, QString &html)
+{
+    MMIOT *markdownHandle = mkd_string(markdown.data(), markdown.size(), 0);
+
+    if (!mkd_compile(markdownHandle, flags)) {
+        mkd_cleanup(markdownHandle);
+        emit error(i18n("Failed to compile the Markdown document."), -1);
+        return false;
+    }
+
+    char *htmlDocument;
+    const int size = mkd_document(markdownHandle, &htmlDocument);
+
+    html = QString::fromUtf8(htmlDocument, size);
+
+    mkd_cleanup(markdownHandle);
+
+    return true;
+}
+
+QSize Converter::imageSize(const QString &fileName)
+{
+    const QDateTime lastModified = QFileInfo(fileName).lastModified();
+    const auto it = m_imageSizes.constFind(fileName);
+    if (it != m_imageSizes.constEnd() && it->first == lastModified)
+        return it->second;
+
+    // only decode the image if its format does not tell the size
+    QImageReader reader(fileName);
+    QSize size = reader.size();
+    if (!size.isValid())
+        size = reader.read().size();
+
+    m_imageSizes.insert(fileName, qMakePair(lastModified, size));
+    return size;
+}
+
 void Converter::extractLinks(QTextFrame *parent, QHash<QString, QTextFragment> &internalLinks, QHash<QString, QTextBlock> &documentAnchors)
 {
     for (QTextFrame::iterator it = parent->begin(); !it.atEnd(); ++it) {
@@ -198,9 +362,9 @@ void Converter::convertImages(const QTextBlock &parent, const QDir &dir, QTextDo
                 const qreal specifiedWidth = textCharFormat.toImageFormat().width();
 
                 format.setName(QDir::cleanPath(dir.absoluteFilePath(textCharFormat.toImageFormat().name())));
-                const QImage img = QImage(format.name());
+                const QSize size = imageSize(format.name());
 
-                setImageSize(format, specifiedWidth, specifiedHeight, img.width(), img.height());
+                setImageSize(format, specifiedWidth, specifiedHeight, size.width(), size.height());
 
                 QTextCursor cursor(textDocument);
                 cursor.setPosition(textFragment.position(), QTextCursor::MoveAnchor);
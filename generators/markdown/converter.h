@@ -12,7 +12,11 @@
 
 #include <core/textdocumentgenerator.h>
 
+#include <QDateTime>
 #include <QDir>
+#include <QHash>
+#include <QPair>
+#include <QSize>
 #include <QTextFragment>
 
 class QTextBlock;
@@ -44,6 +48,8 @@ public:
     QTextDocument *convertOpenFile();
 
 private:
+    bool convertSection(QByteArray markdown, int flags, QString &html);
+    QSize imageSize(const QString &fileName);
     void extractLinks(QTextFrame *parent, QHash<QString, QTextFragment> &internalLinks, QHash<QString, QTextBlock> &documentAnchors);
     void extractLinks(const QTextBlock &parent, QHash<QString, QTextFragment> &internalLinks, QHash<QString, QTextBlock> &documentAnchors);
     void convertImages(QTextFrame *parent, const QDir &dir, QTextDocument *textDocument);
@@ -53,6 +59,12 @@ private:
     FILE *m_markdownFile;
     QDir m_fileDir;
     bool m_isFancyPantsEnabled;
+
+    // the HTML of the sections of the last conversion, by hash of their source,
+    // so that a reload only runs discount over the sections that changed
+    QHash<QByteArray, QString> m_sectionsHtml;
+    // the sizes of the images, with the modification time they were read at
+    QHash<QString, QPair<QDateTime, QSize>> m_imageSizes;
 };
 
 }
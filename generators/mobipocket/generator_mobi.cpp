@@ -19,6 +19,9 @@ OKULAR_EXPORT_PLUGIN(MobiGenerator, "libokularGenerator_mobi.json")
 MobiGenerator::MobiGenerator(QObject *parent, const QVariantList &args)
     : Okular::TextDocumentGenerator(new Mobi::Converter, QStringLiteral("okular_mobi_generator_settings"), parent, args)
 {
+    // the document changes the palette of the application while it is
+    // converted, which can only be done from the GUI thread
+    setFeature(AsynchronousLoading, false);
 }
 
 void MobiGenerator::addPages(KConfigDialog *dlg)
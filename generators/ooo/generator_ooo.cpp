@@ -21,6 +21,9 @@ OKULAR_EXPORT_PLUGIN(KOOOGenerator, "libokularGenerator_ooo.json")
 KOOOGenerator::KOOOGenerator(QObject *parent, const QVariantList &args)
     : Okular::TextDocumentGenerator(new OOO::Converter, QStringLiteral("okular_ooo_generator_settings"), parent, args)
 {
+    // encrypted documents are only found while converting, when it is too
+    // late to ask for their password if that happens in the background
+    setFeature(AsynchronousLoading, false);
 }
 
 void KOOOGenerator::addPages(KConfigDialog *dlg)
@@ -46,6 +46,7 @@ GSGenerator::GSGenerator(QObject *parent, const QVariantList &args)
 {
     setFeature(PrintPostscript);
     setFeature(PrintToFile);
+    setFeature(TiledRendering);
 
     GSRendererThread *renderer = GSRendererThread::getCreateRenderer();
     if (!renderer->isRunning())
@@ -166,13 +167,13 @@ void GSGenerator::slotImageGenerated(QImage *img, Okular::PixmapRequest *request
     if (request != m_request)
         return;
 
-    if (!request->page()->isBoundingBoxKnown())
+    if (!request->isTile() && !request->page()->isBoundingBoxKnown())
         updatePageBoundingBox(request->page()->number(), Okular::Utils::imageBoundingBox(img));
 
     m_request = nullptr;
     QPixmap *pix = new QPixmap(QPixmap::fromImage(*img));
     delete img;
-    request->page()->setPixmap(request->observer(), pix);
+    request->page()->setPixmap(request->observer(), pix, request->isTile() ? request->normalizedRect() : Okular::NormalizedRect());
     signalPixmapRequestDone(request);
 }
 
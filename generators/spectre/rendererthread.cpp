@@ -44,6 +44,22 @@ void GSRendererThread::addRequest(const GSRendererThreadRequest &req)
     m_semaphore.release();
 }
 
+// Maps @p rect of a page rotated by @p orientation back to the unrotated
+// page, that is @p width x @p height
+static QRect unrotatedRect(const QRect &rect, int orientation, int width, int height)
+{
+    switch (orientation) {
+    case Okular::Rotation90:
+        return QRect(rect.y(), height - rect.x() - rect.width(), rect.height(), rect.width());
+    case Okular::Rotation180:
+        return QRect(width - rect.x() - rect.width(), height - rect.y() - rect.height(), rect.width(), rect.height());
+    case Okular::Rotation270:
+        return QRect(width - rect.y() - rect.height(), rect.x(), rect.height(), rect.width());
+    default:
+        return rect;
+    }
+}
+
 void GSRendererThread::run()
 {
     while (true) {
@@ -68,7 +84,18 @@ void GSRendererThread::run()
             if (req.orientation % 2)
                 qSwap(wantedWidth, wantedHeight);
 
-            spectre_page_render(req.spectrePage, m_renderContext, &data, &row_length);
+            // Tiles are rendered as a slice of the page; the tile rect is in the
+            // orientation of the page, the slice before rotating it there
+            QRect tileRect;
+            if (req.request->isTile()) {
+                tileRect = req.request->normalizedRect().geometry(req.request->width(), req.request->height());
+                const QRect slice = unrotatedRect(tileRect, req.orientation, wantedWidth, wantedHeight);
+                spectre_page_render_slice(req.spectrePage, m_renderContext, slice.x(), slice.y(), slice.width(), slice.height(), &data, &row_length);
+                wantedWidth = slice.width();
+                wantedHeight = slice.height();
+            } else {
+                spectre_page_render(req.spectrePage, m_renderContext, &data, &row_length);
+            }
 
             // Qt needs the missing alpha of QImage::Format_RGB32 to be 0xff
             if (data && data[3] != 0xff) {
@@ -76,14 +103,11 @@ void GSRendererThread::run()
                     data[i] = 0xff;
             }
 
+            // The image takes the ownership of the rendered data, so the row padding
+            // does not need to be dropped with a copy
             QImage img;
-            if (row_length == wantedWidth * 4) {
-                img = QImage(data, wantedWidth, wantedHeight, QImage::Format_RGB32);
-            } else {
-                // In case this ends up beign very slow we can try with some memmove
-                QImage aux(data, row_length / 4, wantedHeight, QImage::Format_RGB32);
-                img = QImage(aux.copy(0, 0, wantedWidth, wantedHeight));
-            }
+            if (data)
+                img = QImage(data, qMin(wantedWidth, row_length / 4), wantedHeight, row_length, QImage::Format_RGB32, free, data);
 
             switch (req.orientation) {
             case Okular::Rotation90: {
@@ -106,17 +130,14 @@ void GSRendererThread::run()
             }
             }
 
-            QImage *image = new QImage(img.copy());
-            free(data);
-
-            if (image->width() != req.request->width() || image->height() != req.request->height()) {
+            const QSize expectedSize = req.request->isTile() ? tileRect.size() : QSize(req.request->width(), req.request->height());
+            if (img.size() != expectedSize) {
                 qCWarning(OkularSpectreDebug).nospace() << "Generated image does not match wanted size: "
-                                                        << "[" << image->width() << "x" << image->height() << "] vs requested "
-                                                        << "[" << req.request->width() << "x" << req.request->height() << "]";
-                QImage aux = image->scaled(wantedWidth, wantedHeight);
-                delete image;
-                image = new QImage(aux);
+                                                        << "[" << img.width() << "x" << img.height() << "] vs requested "
+                                                        << "[" << expectedSize.width() << "x" << expectedSize.height() << "]";
+                img = img.scaled(expectedSize);
             }
+            QImage *image = new QImage(img);
             emit imageDone(image, req.request);
 
             spectre_page_free(req.spectrePage);
@@ -30,6 +30,8 @@
 #include <tiff.h>
 #include <tiffio.h>
 
+#include "../fax/bilevelimage.h"
+
 #define TiffDebug 4714
 
 tsize_t okular_tiffReadProc(thandle_t handle, tdata_t buf, tsize_t size)
@@ -89,12 +91,17 @@ public:
     Private()
         : tiff(nullptr)
         , dev(nullptr)
+        , imagePage(-1)
     {
     }
 
     TIFF *tiff;
     QByteArray data;
     QIODevice *dev;
+
+    // the last decoded page, so that its tiles don't decode it again
+    int imagePage;
+    QImage image;
 };
 
 static QDateTime convertTIFFDateTime(const char *tiffdate)
@@ -155,6 +162,71 @@ static Okular::Rotation readTiffRotation(TIFF *tiff)
     return ret;
 }
 
+// Reads the current directory in QImage::Format_MonoLSB if it is a bilevel
+// image stored in strips, such as a fax; returns a null image otherwise
+static QImage readBilevelImage(TIFF *tiff)
+{
+    uint16 bitsPerSample = 1;
+    uint16 samplesPerPixel = 1;
+    uint16 photometric = 0;
+    uint16 orientation = ORIENTATION_TOPLEFT;
+    uint32 width = 0;
+    uint32 height = 0;
+    TIFFGetFieldDefaulted(tiff, TIFFTAG_BITSPERSAMPLE, &bitsPerSample);
+    TIFFGetFieldDefaulted(tiff, TIFFTAG_SAMPLESPERPIXEL, &samplesPerPixel);
+    TIFFGetFieldDefaulted(tiff, TIFFTAG_ORIENTATION, &orientation);
+    if (bitsPerSample != 1 || samplesPerPixel != 1 || orientation != ORIENTATION_TOPLEFT || TIFFIsTiled(tiff))
+        return QImage();
+    if (!TIFFGetField(tiff, TIFFTAG_PHOTOMETRIC, &photometric) || (photometric != PHOTOMETRIC_MINISWHITE && photometric != PHOTOMETRIC_MINISBLACK))
+        return QImage();
+    if (TIFFGetField(tiff, TIFFTAG_IMAGEWIDTH, &width) != 1 || TIFFGetField(tiff, TIFFTAG_IMAGELENGTH, &height) != 1)
+        return QImage();
+
+    // libtiff gives the scanlines with the most significant bit first
+    QImage image(width, height, QImage::Format_Mono);
+    if (image.isNull() || TIFFScanlineSize(tiff) > image.bytesPerLine())
+        return QImage();
+    for (uint32 y = 0; y < height; ++y) {
+        if (TIFFReadScanline(tiff, image.scanLine(y), y) < 0)
+            return QImage();
+    }
+
+    const QRgb white = qRgb(255, 255, 255);
+    const QRgb black = qRgb(0, 0, 0);
+    image.setColorTable(photometric == PHOTOMETRIC_MINISWHITE ? QVector<QRgb> {white, black} : QVector<QRgb> {black, white});
+    return image.convertToFormat(QImage::Format_MonoLSB);
+}
+
+// Reads the current directory in QImage::Format_RGB32
+static QImage readRGBImage(TIFF *tiff)
+{
+    uint32 width = 1;
+    uint32 height = 1;
+    uint32 orientation = 0;
+    TIFFGetField(tiff, TIFFTAG_IMAGEWIDTH, &width);
+    TIFFGetField(tiff, TIFFTAG_IMAGELENGTH, &height);
+
+    if (!TIFFGetField(tiff, TIFFTAG_ORIENTATION, &orientation))
+        orientation = ORIENTATION_TOPLEFT;
+
+    QImage image(width, height, QImage::Format_RGB32);
+    uint32 *data = reinterpret_cast<uint32 *>(image.bits());
+
+    // read data
+    if (TIFFReadRGBAImageOriented(tiff, width, height, data, orientation) == 0)
+        return QImage();
+
+    // an image read by ReadRGBAImage is ABGR, we need ARGB, so swap red and blue
+    uint32 size = width * height;
+    for (uint32 i = 0; i < size; ++i) {
+        uint32 red = (data[i] & 0x00FF0000) >> 16;
+        uint32 blue = (data[i] & 0x000000FF) << 16;
+        data[i] = (data[i] & 0xFF00FF00) + red + blue;
+    }
+
+    return image;
+}
+
 OKULAR_EXPORT_PLUGIN(TIFFGenerator, "libokularGenerator_tiff.json")
 
 TIFFGenerator::TIFFGenerator(QObject *parent, const QVariantList &args)
@@ -162,6 +234,7 @@ TIFFGenerator::TIFFGenerator(QObject *parent, const QVariantList &args)
     , d(new Private)
 {
     setFeature(Threaded);
+    setFeature(TiledRendering);
     setFeature(PrintNative);
     setFeature(PrintToFile);
     setFeature(ReadRawData);
@@ -221,51 +294,48 @@ bool TIFFGenerator::doCloseDocument()
         d->data.clear();
         m_pageMapping.clear();
     }
+    d->imagePage = -1;
+    d->image = QImage();
 
     return true;
 }
 
 QImage TIFFGenerator::image(Okular::PixmapRequest *request)
 {
-    bool generated = false;
-    QImage img;
-
-    if (TIFFSetDirectory(d->tiff, mapPage(request->page()->number()))) {
-        int rotation = request->page()->rotation();
-        uint32 width = 1;
-        uint32 height = 1;
-        uint32 orientation = 0;
-        TIFFGetField(d->tiff, TIFFTAG_IMAGEWIDTH, &width);
-        TIFFGetField(d->tiff, TIFFTAG_IMAGELENGTH, &height);
-
-        if (!TIFFGetField(d->tiff, TIFFTAG_ORIENTATION, &orientation))
-            orientation = ORIENTATION_TOPLEFT;
-
-        QImage image(width, height, QImage::Format_RGB32);
-        uint32 *data = reinterpret_cast<uint32 *>(image.bits());
-
-        // read data
-        if (TIFFReadRGBAImageOriented(d->tiff, width, height, data, orientation) != 0) {
-            // an image read by ReadRGBAImage is ABGR, we need ARGB, so swap red and blue
-            uint32 size = width * height;
-            for (uint32 i = 0; i < size; ++i) {
-                uint32 red = (data[i] & 0x00FF0000) >> 16;
-                uint32 blue = (data[i] & 0x000000FF) << 16;
-                data[i] = (data[i] & 0xFF00FF00) + red + blue;
-            }
-
-            int reqwidth = request->width();
-            int reqheight = request->height();
-            if (rotation % 2 == 1)
-                qSwap(reqwidth, reqheight);
-            img = image.scaled(reqwidth, reqheight, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    int reqwidth = request->width();
+    int reqheight = request->height();
+    QRect rect;
+    if (request->isTile()) {
+        rect = request->normalizedRect().geometry(reqwidth, reqheight);
+    } else {
+        if (request->page()->rotation() % 2 == 1)
+            qSwap(reqwidth, reqheight);
+        rect = QRect(0, 0, reqwidth, reqheight);
+    }
 
-            generated = true;
+    const int pageNumber = request->page()->number();
+    if (d->imagePage != pageNumber) {
+        d->image = QImage();
+        if (TIFFSetDirectory(d->tiff, mapPage(pageNumber))) {
+            // bilevel pages are scaled from their bits, see BilevelImage
+            d->image = readBilevelImage(d->tiff);
+            if (d->image.isNull() && TIFFSetDirectory(d->tiff, mapPage(pageNumber)))
+                d->image = readRGBImage(d->tiff);
         }
+        d->imagePage = pageNumber;
     }
 
-    if (!generated) {
-        img = QImage(request->width(), request->height(), QImage::Format_RGB32);
+    QImage img;
+    if (d->image.format() == QImage::Format_MonoLSB) {
+        img = BilevelImage::scaled(d->image, reqwidth, reqheight, rect);
+    } else if (!d->image.isNull()) {
+        // scale only the part of the page the request covers
+        const double xScale = (double)d->image.width() / reqwidth;
+        const double yScale = (double)d->image.height() / reqheight;
+        const QRect source = QRectF(rect.x() * xScale, rect.y() * yScale, rect.width() * xScale, rect.height() * yScale).toAlignedRect() & d->image.rect();
+        img = d->image.copy(source).scaled(rect.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    } else {
+        img = QImage(rect.size(), QImage::Format_RGB32);
         img.fill(qRgb(255, 255, 255));
     }
 
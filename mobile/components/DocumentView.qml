@@ -178,16 +178,19 @@ QQC2.ScrollView {
                 PageView {
                     id: page1
                     document: root.document
+                    flickable: flick
                     z: 2
                 }
                 PageView {
                     id: page2
                     document: root.document
+                    flickable: flick
                     z: 1
                 }
                 PageView {
                     id: page3
                     document: root.document
+                    flickable: flick
                     z: 0
                 }
 
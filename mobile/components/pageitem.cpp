@@ -26,12 +26,16 @@
 #include <QStyleOptionGraphicsItem>
 #include <QTimer>
 
+#include <algorithm>
+
 #include <core/bookmarkmanager.h>
 #include <core/document.h>
 #include <core/generator.h>
 #include <core/page.h>
+#include <core/tile.h>
 
 #include "settings.h"
+#include "settings_core.h"
 #include "ui/pagepainter.h"
 #include "ui/priorities.h"
 
@@ -44,6 +48,7 @@ PageItem::PageItem(QQuickItem *parent)
     , m_smooth(false)
     , m_bookmarked(false)
     , m_isThumbnail(false)
+    , m_tilesRenderMode(-1)
 {
     setFlag(QQuickItem::ItemHasContents, true);
 
@@ -303,26 +308,63 @@ void PageItem::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeome
 
 QSGNode *PageItem::updatePaintNode(QSGNode *node, QQuickItem::UpdatePaintNodeData * /*data*/)
 {
-    if (!window() || m_buffer.isNull()) {
+    QVector<TileTexture> textures = m_tiles;
+    if (!m_overlay.image.isNull()) {
+        textures.append(m_overlay);
+    }
+
+    if (!window() || textures.isEmpty()) {
         delete node;
+        m_tileNodes.clear();
         return nullptr;
     }
-    QSGSimpleTextureNode *n = static_cast<QSGSimpleTextureNode *>(node);
-    if (!n) {
-        n = new QSGSimpleTextureNode();
-        n->setOwnsTexture(true);
+    if (!node) {
+        node = new QSGNode();
+    }
+
+    // Every tile is a texture node of its own, only the textures of the tiles
+    // that changed since the last update get uploaded
+    QVector<TileNode> tileNodes;
+    tileNodes.reserve(textures.count());
+    for (const TileTexture &tile : qAsConst(textures)) {
+        QSGSimpleTextureNode *tileNode = nullptr;
+        for (int i = 0; i < m_tileNodes.count(); ++i) {
+            if (m_tileNodes.at(i).cacheKey == tile.cacheKey) {
+                tileNode = m_tileNodes.takeAt(i).node;
+                break;
+            }
+        }
+        if (!tileNode) {
+            tileNode = new QSGSimpleTextureNode();
+            tileNode->setOwnsTexture(true);
+            tileNode->setTexture(window()->createTextureFromImage(tile.image));
+        }
+        tileNode->setRect(QRectF(tile.rect.left * width(), tile.rect.top * height(), tile.rect.width() * width(), tile.rect.height() * height()));
+        tileNodes.append({tile.cacheKey, tileNode});
+    }
+
+    node->removeAllChildNodes();
+    for (const TileNode &oldNode : qAsConst(m_tileNodes)) {
+        delete oldNode.node;
+    }
+    m_tileNodes = tileNodes;
+
+    // The tiles are drawn in the order of m_tiles, so that the coarse ones
+    // kept meanwhile stay below the sharper tiles rendered since, and the
+    // overlay comes last
+    for (const TileNode &tileNode : qAsConst(m_tileNodes)) {
+        node->appendChildNode(tileNode.node);
     }
 
-    n->setTexture(window()->createTextureFromImage(m_buffer));
-    n->setRect(boundingRect());
-    return n;
+    return node;
 }
 
 void PageItem::requestPixmap()
 {
     if (!m_documentItem || !m_page || !window() || width() <= 0 || height() < 0) {
-        if (!m_buffer.isNull()) {
-            m_buffer = QImage();
+        if (!m_tiles.isEmpty() || !m_overlay.image.isNull()) {
+            m_tiles.clear();
+            m_overlay = TileTexture();
             update();
         }
         return;
@@ -342,18 +384,95 @@ void PageItem::requestPixmap()
     paint();
     {
         auto request = new Okular::PixmapRequest(observer, m_viewPort.pageNumber, width() * dpr, height() * dpr, priority, Okular::PixmapRequest::Asynchronous);
-        request->setNormalizedRect(Okular::NormalizedRect(0, 0, 1, 1));
+        // Asking only for the visible part of a zoomed page lets the document switch to tiles
+        request->setNormalizedRect(visibleRect());
+        request->setTile(m_page->hasTilesManager(observer));
         const Okular::Document::PixmapRequestFlag prf = Okular::Document::NoOption;
         m_documentItem.data()->document()->requestPixmaps({request}, prf);
     }
 }
 
+Okular::NormalizedRect PageItem::visibleRect() const
+{
+    QRectF viewport;
+    if (m_flickable) {
+        viewport = mapRectFromItem(m_flickable.data(), QRectF(0, 0, m_flickable.data()->width(), m_flickable.data()->height()));
+    } else if (window()) {
+        viewport = mapRectFromScene(QRectF(0, 0, window()->width(), window()->height()));
+    }
+
+    const QRectF visible = viewport.intersected(boundingRect());
+    if (visible.isEmpty() || width() <= 0 || height() <= 0) {
+        return Okular::NormalizedRect(0, 0, 1, 1);
+    }
+
+    return Okular::NormalizedRect(visible.left() / width(), visible.top() / height(), visible.right() / width(), visible.bottom() / height());
+}
+
 void PageItem::paint()
 {
     Observer *observer = m_isThumbnail ? m_documentItem.data()->thumbnailObserver() : m_documentItem.data()->pageviewObserver();
-    const int flags = PagePainter::Accessibility | PagePainter::Highlights | PagePainter::Annotations;
 
+    const int flags = PagePainter::Accessibility | PagePainter::Highlights | PagePainter::Annotations;
     const qreal dpr = window()->devicePixelRatio();
+
+    // The tiles of a zoomed page are shown as they are, recolored if needed
+    if (m_page->hasTilesManager(observer)) {
+        const bool changeColors = Okular::SettingsCore::changeColors() && Okular::SettingsCore::renderMode() != Okular::SettingsCore::EnumRenderMode::Paper;
+        const int renderMode = changeColors ? Okular::SettingsCore::renderMode() : -1;
+        const QList<Okular::Tile> tiles = m_page->tilesAt(observer, Okular::NormalizedRect(0, 0, 1, 1));
+        // Until the tiles of a new zoom level are rendered, the old ones are kept scaled
+        if (tiles.isEmpty()) {
+            return;
+        }
+        if (renderMode != m_tilesRenderMode) {
+            m_tiles.clear();
+            m_tilesRenderMode = renderMode;
+        }
+
+        QVector<TileTexture> textures;
+        textures.reserve(tiles.count());
+        for (const Okular::Tile &tile : tiles) {
+            const qint64 cacheKey = tile.pixmap()->cacheKey();
+            auto it = std::find_if(m_tiles.constBegin(), m_tiles.constEnd(), [cacheKey](const TileTexture &texture) { return texture.cacheKey == cacheKey; });
+            if (it != m_tiles.constEnd()) {
+                textures.append({tile.rect(), cacheKey, it->image});
+            } else {
+                QImage image = tile.pixmap()->toImage();
+                if (changeColors) {
+                    image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+                    PagePainter::changeImageColors(&image);
+                }
+                textures.append({tile.rect(), cacheKey, image});
+            }
+        }
+        m_tiles = textures;
+
+        // The highlights and annotations are painted by PagePainter over the
+        // visible part of the page only, in a node on top of the tile nodes;
+        // the highlights are multiplied with the page, so the overlay includes it
+        m_overlay = TileTexture();
+        if (m_page->hasHighlights() || m_page->hasAnnotations()) {
+            const Okular::NormalizedRect visible = visibleRect();
+            const QRect limits = visible.geometry(width(), height());
+            if (!limits.isEmpty()) {
+                QPixmap pix(limits.size() * dpr);
+                pix.setDevicePixelRatio(dpr);
+                QPainter p(&pix);
+                p.setRenderHint(QPainter::Antialiasing, m_smooth);
+                p.translate(-limits.topLeft());
+                PagePainter::paintPageOnPainter(&p, m_page, observer, flags, width(), height(), limits);
+                p.end();
+
+                const QImage buffer = pix.toImage();
+                m_overlay = {Okular::NormalizedRect(limits, width(), height()), buffer.cacheKey(), buffer};
+            }
+        }
+
+        update();
+        return;
+    }
+
     const QRect limits(QPoint(0, 0), QSize(width() * dpr, height() * dpr));
     QPixmap pix(limits.size());
     pix.setDevicePixelRatio(dpr);
@@ -362,7 +481,10 @@ void PageItem::paint()
     PagePainter::paintPageOnPainter(&p, m_page, observer, flags, width(), height(), limits);
     p.end();
 
-    m_buffer = pix.toImage();
+    const QImage buffer = pix.toImage();
+    m_tiles = {{Okular::NormalizedRect(0, 0, 1, 1), buffer.cacheKey(), buffer}};
+    m_tilesRenderMode = -1;
+    m_overlay = TileTexture();
 
     update();
 }
@@ -406,6 +528,11 @@ void PageItem::contentXChanged()
     }
 
     m_viewPort.rePos.normalizedX = m_flickable.data()->property("contentX").toReal() / (width() - m_flickable.data()->width());
+
+    // panning a tiled page needs the tiles that became visible
+    if (m_page && m_documentItem && m_page->hasTilesManager(m_isThumbnail ? m_documentItem.data()->thumbnailObserver() : m_documentItem.data()->pageviewObserver())) {
+        m_redrawTimer->start();
+    }
 }
 
 void PageItem::contentYChanged()
@@ -415,6 +542,11 @@ void PageItem::contentYChanged()
     }
 
     m_viewPort.rePos.normalizedY = m_flickable.data()->property("contentY").toReal() / (height() - m_flickable.data()->height());
+
+    // panning a tiled page needs the tiles that became visible
+    if (m_page && m_documentItem && m_page->hasTilesManager(m_isThumbnail ? m_documentItem.data()->thumbnailObserver() : m_documentItem.data()->pageviewObserver())) {
+        m_redrawTimer->start();
+    }
 }
 
 void PageItem::setIsThumbnail(bool thumbnail)
@@ -23,10 +23,13 @@
 #include <QImage>
 #include <QPointer>
 #include <QQuickItem>
+#include <QVector>
 
+#include <core/area.h>
 #include <core/document.h>
 #include <core/view.h>
 
+class QSGSimpleTextureNode;
 class QTimer;
 
 class DocumentItem;
@@ -162,6 +165,19 @@ private Q_SLOTS:
 private:
     void paint();
     void refreshPage();
+    Okular::NormalizedRect visibleRect() const;
+
+    // An image to be shown as one texture node covering rect of the page
+    struct TileTexture {
+        Okular::NormalizedRect rect;
+        qint64 cacheKey;
+        QImage image;
+    };
+
+    struct TileNode {
+        qint64 cacheKey;
+        QSGSimpleTextureNode *node;
+    };
 
     const Okular::Page *m_page;
     bool m_smooth;
@@ -171,7 +187,13 @@ private:
     QTimer *m_redrawTimer;
     QPointer<QQuickItem> m_flickable;
     Okular::DocumentViewport m_viewPort;
-    QImage m_buffer;
+    QVector<TileTexture> m_tiles;
+    // the render mode m_tiles were recolored with, -1 if they weren't
+    int m_tilesRenderMode;
+    // the highlights and annotations over the visible part of a tiled page
+    TileTexture m_overlay;
+    // only touched by updatePaintNode(), i.e. with the GUI thread blocked
+    QVector<TileNode> m_tileNodes;
 };
 
 #endif
@@ -27,6 +27,7 @@ Item {
     height: parent.height
     readonly property PageItem pageItem: page
     property alias document: page.document
+    property alias flickable: page.flickable
     property alias pageNumber: page.pageNumber
     implicitWidth: page.implicitWidth
     implicitHeight: page.implicitHeight
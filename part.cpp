@@ -519,6 +519,8 @@ Part::Part(QWidget *parentWidget, QObject *parent, const QVariantList &args)
     connect(m_document, &Document::warning, this, &Part::warningMessage);
     connect(m_document, &Document::notice, this, &Part::noticeMessage);
     connect(m_document, &Document::sourceReferenceActivated, this, &Part::slotHandleActivatedSourceReference);
+    // not from within the generator that reports the failure
+    connect(m_document, &Document::documentLoadingFailed, this, &Part::slotDocumentLoadingFailed, Qt::QueuedConnection);
     connect(m_pageView.data(), &PageView::fitWindowToPage, this, &Part::fitWindowToPage);
     rightLayout->addWidget(m_pageView);
     m_layers->setPageView(m_pageView);
@@ -1076,6 +1078,17 @@ void Part::slotHandleActivatedSourceReference(const QString &absFileName, int li
     }
 }
 
+void Part::slotDocumentLoadingFailed()
+{
+    // a document opened asynchronously turned out not to be loadable,
+    // close it as if openUrl() had failed
+    /* TRANSLATORS: Adding the reason (%2) why the opening failed (if any). */
+    const QString errorMessage = i18n("Could not open %1. %2", url().toDisplayString(), QStringLiteral("\n%1").arg(m_document->openError()));
+    resetStartArguments();
+    closeUrl(false);
+    KMessageBox::error(widget(), errorMessage);
+}
+
 void Part::openUrlFromDocument(const QUrl &url)
 {
     if (m_embedMode == PrintPreviewMode)
@@ -1196,7 +1209,7 @@ KConfigDialog *Part::slotGeneratorPreferences()
     return dialog;
 }
 
-void Part::notifySetup(const QVector<Okular::Page *> & /*pages*/, int setupFlags)
+void Part::notifySetup(const QVector<Okular::Page *> &pages, int setupFlags)
 {
     // Hide the migration message if the user has just migrated. Otherwise,
     // if m_migrationMessage is already hidden, this does nothing.
@@ -1206,6 +1219,10 @@ void Part::notifySetup(const QVector<Okular::Page *> & /*pages*/, int setupFlags
     if (!(setupFlags & Okular::DocumentObserver::DocumentChanged))
         return;
 
+    // the title of a document opened asynchronously is known once it is loaded
+    if (!pages.isEmpty())
+        setWindowTitleFromDocument();
+
     rebuildBookmarkMenu();
     updateAboutBackendAction();
     m_findBar->resetSearch();
@@ -1477,6 +1494,10 @@ bool Part::openFile()
         mimes << pathMime;
     }
 
+    // the document is shown while it is loading, except when it is printed
+    // or searched as soon as it is opened, which needs all of its pages
+    m_document->setOpenAsynchronously(m_embedMode != PrintPreviewMode && !m_cliPrint && !m_cliPrintAndExit && m_textToFindOnOpen.isEmpty());
+
     QMimeType mime;
     Document::OpenResult openResult = Document::OpenError;
     bool isCompressedFile = false;
@@ -1960,6 +1981,8 @@ bool Part::slotAttemptReload(bool oneShot, const QUrl &newUrl)
 
     bool reloadSucceeded = false;
 
+    // a document opened asynchronously gets its pages once it is loaded
+    m_document->setNextDocumentViewport(m_viewportDirty);
     if (KParts::ReadWritePart::openUrl(m_oldUrl)) {
         // on successful opening, restore the previous viewport
         if (m_viewportDirty.pageNumber >= (int)m_document->pages())
@@ -1985,6 +2008,9 @@ bool Part::slotAttemptReload(bool oneShot, const QUrl &newUrl)
         m_dirtyHandler->start(750);
     }
 
+    if (!reloadSucceeded)
+        m_document->setNextDocumentViewport(Okular::DocumentViewport());
+
     return reloadSucceeded;
 }
 
@@ -424,6 +424,7 @@ private:
 private Q_SLOTS:
     void slotAnnotationPreferences();
     void slotHandleActivatedSourceReference(const QString &absFileName, int line, int col, bool *handled);
+    void slotDocumentLoadingFailed();
 };
 
 }
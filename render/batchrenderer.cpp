@@ -0,0 +1,311 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by The Okular Developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "batchrenderer.h"
+
+#include <KLocalizedString>
+#include <QDir>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QImage>
+#include <QMimeDatabase>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPixmap>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QUrl>
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+
+#include "core/document.h"
+#include "core/generator.h"
+#include "core/page.h"
+#include "core/utils.h"
+#include "renderutils.h"
+
+// how many pages of a document are requested at a time, enough to keep the
+// generator busy while the page it just rendered is written
+#define RENDER_REQUESTS_WINDOW 2
+
+namespace
+{
+QMutex outputMutex;
+
+void printLine(FILE *stream, const QString &line)
+{
+    QMutexLocker locker(&outputMutex);
+    fputs(qPrintable(line + QLatin1Char('\n')), stream);
+    fflush(stream);
+}
+
+// Encodes and writes a page in the thread pool, so that the main thread
+// keeps feeding the generators
+class ImageWriter : public QRunnable
+{
+public:
+    ImageWriter(const QImage &image, const QString &outputFileName, RenderOptions::Format format, const QString &report, QAtomicInt *failures)
+        : m_image(image)
+        , m_outputFileName(outputFileName)
+        , m_format(format)
+        , m_report(report)
+        , m_failures(failures)
+    {
+    }
+
+    void run() override
+    {
+        QSaveFile file(m_outputFileName);
+        bool written = file.open(QIODevice::WriteOnly);
+        if (written) {
+            if (m_format == RenderOptions::Png) {
+                written = m_image.save(&file, "PNG");
+            } else {
+                const QImage rgba = m_image.convertToFormat(QImage::Format_RGBA8888);
+                const int rowBytes = rgba.width() * 4;
+                for (int y = 0; y < rgba.height() && written; ++y)
+                    written = file.write(reinterpret_cast<const char *>(rgba.constScanLine(y)), rowBytes) == rowBytes;
+            }
+            written = written && file.commit();
+        }
+
+        if (written) {
+            printLine(stdout, m_report);
+        } else {
+            m_failures->ref();
+            printLine(stderr, i18n("Could not write %1: %2", m_outputFileName, file.errorString()));
+        }
+    }
+
+private:
+    const QImage m_image;
+    const QString m_outputFileName;
+    const RenderOptions::Format m_format;
+    const QString m_report;
+    QAtomicInt *m_failures;
+};
+}
+
+RenderWorker::RenderWorker(const RenderOptions &options, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_document(new Okular::Document(nullptr))
+{
+    m_document->addObserver(this);
+
+    m_timeoutTimer.setSingleShot(true);
+    m_timeoutTimer.setInterval(m_options.timeout * 1000);
+    connect(&m_timeoutTimer, &QTimer::timeout, this, &RenderWorker::slotTimeout);
+}
+
+RenderWorker::~RenderWorker()
+{
+    m_document->closeDocument();
+    m_document->removeObserver(this);
+    delete m_document;
+}
+
+void RenderWorker::render(const QString &fileName)
+{
+    m_fileName = fileName;
+
+    QMimeDatabase db;
+    const QMimeType mime = db.mimeTypeForFile(fileName);
+    const Okular::Document::OpenResult result = m_document->openDocument(fileName, QUrl::fromLocalFile(fileName), mime);
+    if (result != Okular::Document::OpenSuccess) {
+        emit pageFailed(fileName, -1, result == Okular::Document::OpenNeedsPassword ? i18n("The document is protected by a password") : m_document->openError());
+        finishFile();
+        return;
+    }
+
+    m_queuedPages = RenderUtils::pagesInRanges(m_options.pageRanges, m_document->pages());
+    if (m_queuedPages.isEmpty()) {
+        emit pageFailed(fileName, -1, i18n("None of the requested pages is in the document"));
+        finishFile();
+        return;
+    }
+
+    m_pageTimer.start();
+    m_timeoutTimer.start();
+    requestPages();
+}
+
+void RenderWorker::requestPages()
+{
+    QLinkedList<Okular::PixmapRequest *> requests;
+    while (m_pendingPages.count() < RENDER_REQUESTS_WINDOW && !m_queuedPages.isEmpty()) {
+        const int page = m_queuedPages.takeFirst();
+
+        // the request is in device independent pixels
+        const QSize size = pixmapSize(m_document->page(page));
+        const qreal dpr = qApp->devicePixelRatio();
+        Okular::PixmapRequest *request = new Okular::PixmapRequest(this, page, qRound(size.width() / dpr), qRound(size.height() / dpr), 1, Okular::PixmapRequest::Asynchronous);
+        m_pendingPages.insert(page, QSize(request->width(), request->height()));
+        requests << request;
+    }
+
+    // the requests of the same priority are generated in the order they are made
+    if (!requests.isEmpty())
+        m_document->requestPixmaps(requests);
+}
+
+void RenderWorker::notifyPageChanged(int page, int flags)
+{
+    if (!(flags & Okular::DocumentObserver::Pixmap) || !m_pendingPages.contains(page))
+        return;
+
+    // partial updates of the page notify a pixmap that isn't complete yet
+    const QSize size = m_pendingPages.value(page);
+    const Okular::Page *okularPage = m_document->page(page);
+    if (!okularPage->hasPixmap(this, size.width(), size.height()))
+        return;
+
+    const QPixmap *pixmap = okularPage->_o_nearestPixmap(this, size.width(), size.height());
+    emit pageRendered(m_fileName, page, m_document->pages(), pixmap->toImage(), m_pageTimer.restart());
+    m_pendingPages.remove(page);
+
+    if (m_pendingPages.isEmpty() && m_queuedPages.isEmpty()) {
+        finishFile();
+    } else {
+        m_timeoutTimer.start();
+        // not from within the generation of this page, as the generators
+        // that aren't threaded would recurse through the whole document
+        QTimer::singleShot(0, this, [this, fileName = m_fileName] {
+            if (fileName == m_fileName)
+                requestPages();
+        });
+    }
+}
+
+bool RenderWorker::canUnloadPixmap(int page) const
+{
+    // the pixmaps that are already written can make room for the others
+    return !m_pendingPages.contains(page);
+}
+
+void RenderWorker::slotTimeout()
+{
+    QList<int> pages = m_pendingPages.keys();
+    std::sort(pages.begin(), pages.end());
+    pages += m_queuedPages;
+    for (int page : qAsConst(pages))
+        emit pageFailed(m_fileName, page, i18n("The page was not rendered in %1 seconds", m_options.timeout));
+    finishFile();
+}
+
+QSize RenderWorker::pixmapSize(const Okular::Page *page) const
+{
+    if (m_options.size.isValid()) {
+        double scale = std::numeric_limits<double>::max();
+        if (m_options.size.width() > 0)
+            scale = m_options.size.width() / page->width();
+        if (m_options.size.height() > 0)
+            scale = qMin(scale, m_options.size.height() / page->height());
+        return QSize(qMax(1, qRound(page->width() * scale)), qMax(1, qRound(page->height() * scale)));
+    }
+
+    // the size of the pages is in pixels at the resolution the document
+    // gives to the generators
+    const double scale = m_options.dpi / Okular::Utils::realDpi(nullptr).width();
+    return QSize(qMax(1, qRound(page->width() * scale)), qMax(1, qRound(page->height() * scale)));
+}
+
+void RenderWorker::finishFile()
+{
+    m_timeoutTimer.stop();
+    m_queuedPages.clear();
+    m_pendingPages.clear();
+    m_fileName.clear();
+
+    // the last page may be notified from within the document's handling of
+    // its request, so close it once that is over
+    QTimer::singleShot(0, this, [this] {
+        m_document->closeDocument();
+        emit finished();
+    });
+}
+
+BatchRenderer::BatchRenderer(const RenderOptions &options, const QStringList &fileNames, int jobs, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_queue(fileNames)
+    , m_busyWorkers(0)
+{
+    const int workers = qMax(1, qMin(jobs, fileNames.count()));
+    for (int i = 0; i < workers; ++i) {
+        RenderWorker *worker = new RenderWorker(m_options, this);
+        connect(worker, &RenderWorker::pageRendered, this, &BatchRenderer::slotPageRendered);
+        connect(worker, &RenderWorker::pageFailed, this, &BatchRenderer::slotPageFailed);
+        connect(worker, &RenderWorker::finished, this, &BatchRenderer::slotWorkerFinished);
+        m_workers << worker;
+    }
+}
+
+BatchRenderer::~BatchRenderer()
+{
+    QThreadPool::globalInstance()->waitForDone();
+}
+
+void BatchRenderer::start()
+{
+    for (RenderWorker *worker : qAsConst(m_workers))
+        renderNextFile(worker);
+
+    if (m_busyWorkers == 0)
+        emit finished();
+}
+
+int BatchRenderer::failures() const
+{
+    return m_failures.load();
+}
+
+void BatchRenderer::renderNextFile(RenderWorker *worker)
+{
+    if (m_queue.isEmpty())
+        return;
+
+    ++m_busyWorkers;
+    worker->render(m_queue.takeFirst());
+}
+
+void BatchRenderer::slotPageRendered(const QString &fileName, int page, int pageCount, const QImage &image, qint64 elapsed)
+{
+    const QString pageNumber = QString::number(page + 1).rightJustified(QString::number(pageCount).length(), QLatin1Char('0'));
+    const QString extension = m_options.format == RenderOptions::Png ? QStringLiteral("png") : QStringLiteral("rgba");
+    const QString outputFileName = QDir(m_options.outputDirectory).filePath(QStringLiteral("%1-%2.%3").arg(QFileInfo(fileName).completeBaseName(), pageNumber, extension));
+
+    // output file, input file, page, size and render time, separated by tabs
+    const QString report = QStringLiteral("%1\t%2\t%3\t%4x%5\t%6").arg(outputFileName, fileName).arg(page + 1).arg(image.width()).arg(image.height()).arg(elapsed);
+    QThreadPool::globalInstance()->start(new ImageWriter(image, outputFileName, m_options.format, report, &m_failures));
+}
+
+void BatchRenderer::slotPageFailed(const QString &fileName, int page, const QString &error)
+{
+    m_failures.ref();
+    if (page < 0)
+        printLine(stderr, i18n("Could not render %1: %2", fileName, error));
+    else
+        printLine(stderr, i18n("Could not render page %1 of %2: %3", page + 1, fileName, error));
+}
+
+void BatchRenderer::slotWorkerFinished()
+{
+    RenderWorker *worker = qobject_cast<RenderWorker *>(sender());
+    --m_busyWorkers;
+    renderNextFile(worker);
+
+    if (m_busyWorkers == 0) {
+        QThreadPool::globalInstance()->waitForDone();
+        emit finished();
+    }
+}
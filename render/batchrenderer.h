@@ -0,0 +1,155 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by The Okular Developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_BATCHRENDERER_H_
+#define _OKULAR_BATCHRENDERER_H_
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QSize>
+#include <QStringList>
+#include <QTimer>
+
+#include "core/observer.h"
+
+class QImage;
+
+namespace Okular
+{
+class Document;
+class Page;
+}
+
+/**
+ * The options of the rendering, the same for all the files.
+ */
+struct RenderOptions {
+    enum Format {
+        Png, ///< PNG files
+        Raw  ///< The bare RGBA pixels, 8 bits per channel, row after row
+    };
+
+    /**
+     * The ranges of pages to render, 1-based and inclusive; a range ending
+     * at -1 goes up to the last page. Empty means all the pages.
+     */
+    QList<QPair<int, int>> pageRanges;
+
+    /**
+     * The resolution the pages are rendered at, unless @ref size is set.
+     */
+    double dpi = 150;
+
+    /**
+     * The size the pages are scaled to fit in, keeping their aspect ratio.
+     * A zero width or height is not a constraint.
+     */
+    QSize size;
+
+    Format format = Png;
+    QString outputDirectory;
+
+    /**
+     * How long to wait for a page before giving up on the file, in seconds.
+     */
+    int timeout = 60;
+};
+
+/**
+ * Renders the pages of a file with its own Okular::Document.
+ *
+ * The pixmaps are requested asynchronously, so the workers of a batch render
+ * in parallel, each in the thread of its own generator.
+ */
+class RenderWorker : public QObject, public Okular::DocumentObserver
+{
+    Q_OBJECT
+
+public:
+    explicit RenderWorker(const RenderOptions &options, QObject *parent = nullptr);
+    ~RenderWorker() override;
+
+    /**
+     * Opens @p fileName and requests its pages, finished() is emitted once
+     * they are all rendered or failed.
+     */
+    void render(const QString &fileName);
+
+    // inherited from DocumentObserver
+    void notifyPageChanged(int page, int flags) override;
+    bool canUnloadPixmap(int page) const override;
+
+Q_SIGNALS:
+    void pageRendered(const QString &fileName, int page, int pageCount, const QImage &image, qint64 elapsed);
+    void pageFailed(const QString &fileName, int page, const QString &error);
+    void finished();
+
+private Q_SLOTS:
+    void slotTimeout();
+
+private:
+    void requestPages();
+    QSize pixmapSize(const Okular::Page *page) const;
+    void finishFile();
+
+    const RenderOptions m_options;
+    Okular::Document *m_document;
+    QString m_fileName;
+    QList<int> m_queuedPages;
+    QHash<int, QSize> m_pendingPages;
+    QElapsedTimer m_pageTimer;
+    QTimer m_timeoutTimer;
+};
+
+/**
+ * Renders a list of files with a pool of workers, writing the pages as soon
+ * as they are rendered and reporting each of them on the standard output.
+ *
+ * With more than one job, documents are rendered at the same time, which
+ * only works with the generators that are safe to use from several
+ * documents at once.
+ */
+class BatchRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    BatchRenderer(const RenderOptions &options, const QStringList &fileNames, int jobs, QObject *parent = nullptr);
+    ~BatchRenderer() override;
+
+    void start();
+
+    /**
+     * The number of pages or files that couldn't be rendered or written.
+     */
+    int failures() const;
+
+Q_SIGNALS:
+    void finished();
+
+private Q_SLOTS:
+    void slotPageRendered(const QString &fileName, int page, int pageCount, const QImage &image, qint64 elapsed);
+    void slotPageFailed(const QString &fileName, int page, const QString &error);
+    void slotWorkerFinished();
+
+private:
+    void renderNextFile(RenderWorker *worker);
+
+    const RenderOptions m_options;
+    QStringList m_queue;
+    QList<RenderWorker *> m_workers;
+    int m_busyWorkers;
+    QAtomicInt m_failures;
+};
+
+#endif
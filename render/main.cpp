@@ -0,0 +1,110 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by The Okular Developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "batchrenderer.h"
+#include "renderutils.h"
+
+#include <KLocalizedString>
+#include <QApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDir>
+
+#include <cstdio>
+
+#include "core/version.h"
+#include "settings_core.h"
+
+int main(int argc, char **argv)
+{
+    // nothing is ever shown, so don't require a display
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    KLocalizedString::setApplicationDomain("okular");
+    QApplication::setApplicationName(QStringLiteral("okular-render"));
+    QApplication::setApplicationVersion(QStringLiteral(OKULAR_VERSION_STRING));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(i18n("Renders pages of documents to image files with the Okular generators"));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("p") << QStringLiteral("pages"), i18n("Pages to render, for example 1-3,5,8- (default: all)"), QStringLiteral("ranges")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("r") << QStringLiteral("dpi"), i18n("Resolution to render the pages at (default: 150)"), QStringLiteral("dpi"), QStringLiteral("150")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("W") << QStringLiteral("width"), i18n("Scale the pages to this width in pixels, instead of using the resolution"), QStringLiteral("pixels")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("H") << QStringLiteral("height"), i18n("Scale the pages to this height in pixels, instead of using the resolution"), QStringLiteral("pixels")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("f") << QStringLiteral("format"), i18n("Output format: png, or raw for the bare RGBA pixels (default: png)"), QStringLiteral("format"), QStringLiteral("png")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("o") << QStringLiteral("output"), i18n("Directory to write the pages to (default: the current one)"), QStringLiteral("directory"), QStringLiteral(".")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("j") << QStringLiteral("jobs"), i18n("Number of documents to render at the same time (default: 1)"), QStringLiteral("jobs"), QStringLiteral("1")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("timeout"), i18n("Seconds to wait for a page before giving up on the document (default: 60)"), QStringLiteral("seconds"), QStringLiteral("60")));
+    parser.addPositionalArgument(QStringLiteral("files"), i18n("Documents to render"), QStringLiteral("files..."));
+    parser.process(app);
+
+    auto fail = [](const QString &message) {
+        fprintf(stderr, "%s\n", qPrintable(message));
+        return 2;
+    };
+
+    const QStringList fileNames = parser.positionalArguments();
+    if (fileNames.isEmpty())
+        return fail(i18n("No documents to render"));
+
+    RenderOptions options;
+    bool ok = true;
+    if (parser.isSet(QStringLiteral("pages")) && !RenderUtils::parsePageRanges(parser.value(QStringLiteral("pages")), &options.pageRanges))
+        return fail(i18n("Invalid page ranges: %1", parser.value(QStringLiteral("pages"))));
+
+    options.dpi = parser.value(QStringLiteral("dpi")).toDouble(&ok);
+    if (!ok || options.dpi <= 0)
+        return fail(i18n("Invalid resolution: %1", parser.value(QStringLiteral("dpi"))));
+
+    if (parser.isSet(QStringLiteral("width")) || parser.isSet(QStringLiteral("height"))) {
+        bool widthOk = true, heightOk = true;
+        const int width = parser.isSet(QStringLiteral("width")) ? parser.value(QStringLiteral("width")).toInt(&widthOk) : 0;
+        const int height = parser.isSet(QStringLiteral("height")) ? parser.value(QStringLiteral("height")).toInt(&heightOk) : 0;
+        if (!widthOk || !heightOk || width < 0 || height < 0 || (width == 0 && height == 0))
+            return fail(i18n("Invalid size"));
+        options.size = QSize(width, height);
+    }
+
+    const QString format = parser.value(QStringLiteral("format"));
+    if (format == QLatin1String("png"))
+        options.format = RenderOptions::Png;
+    else if (format == QLatin1String("raw"))
+        options.format = RenderOptions::Raw;
+    else
+        return fail(i18n("Unknown format: %1", format));
+
+    options.outputDirectory = parser.value(QStringLiteral("output"));
+    if (!QDir().mkpath(options.outputDirectory))
+        return fail(i18n("Could not create the directory %1", options.outputDirectory));
+
+    options.timeout = parser.value(QStringLiteral("timeout")).toInt(&ok);
+    if (!ok || options.timeout <= 0)
+        return fail(i18n("Invalid timeout: %1", parser.value(QStringLiteral("timeout"))));
+
+    // the generators aren't all safe to use from several documents at the
+    // same time, so only render in parallel when asked to
+    const int jobs = parser.value(QStringLiteral("jobs")).toInt(&ok);
+    if (!ok || jobs < 1)
+        return fail(i18n("Invalid number of jobs: %1", parser.value(QStringLiteral("jobs"))));
+
+    // a configuration of its own, so that the user's settings don't apply;
+    // the pixmaps that are written are evicted when the memory is needed
+    Okular::SettingsCore::instance(QStringLiteral("okular-renderrc"));
+    Okular::SettingsCore::setMemoryLevel(Okular::SettingsCore::EnumMemoryLevel::Normal);
+
+    BatchRenderer renderer(options, fileNames, jobs);
+    QObject::connect(&renderer, &BatchRenderer::finished, &app, &QCoreApplication::quit, Qt::QueuedConnection);
+    renderer.start();
+    app.exec();
+
+    return renderer.failures() > 0 ? 1 : 0;
+}
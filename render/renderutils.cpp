@@ -0,0 +1,52 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by The Okular Developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "renderutils.h"
+
+#include <QStringList>
+
+namespace RenderUtils
+{
+bool parsePageRanges(const QString &text, QList<QPair<int, int>> *ranges)
+{
+    const QStringList parts = text.split(QLatin1Char(','), QString::SkipEmptyParts);
+    for (const QString &part : parts) {
+        const int dash = part.indexOf(QLatin1Char('-'));
+        bool firstOk = true, lastOk = true;
+        const int first = part.left(dash == -1 ? part.length() : dash).trimmed().toInt(&firstOk);
+        int last = first;
+        if (dash != -1) {
+            const QString lastText = part.mid(dash + 1).trimmed();
+            last = lastText.isEmpty() ? -1 : lastText.toInt(&lastOk);
+        }
+        if (!firstOk || !lastOk || first < 1 || (last != -1 && last < first))
+            return false;
+        ranges->append(qMakePair(first, last));
+    }
+    return !ranges->isEmpty();
+}
+
+QList<int> pagesInRanges(const QList<QPair<int, int>> &ranges, int pageCount)
+{
+    QList<QPair<int, int>> allRanges = ranges;
+    if (allRanges.isEmpty())
+        allRanges << qMakePair(1, pageCount);
+
+    QList<int> pages;
+    for (const QPair<int, int> &range : qAsConst(allRanges)) {
+        const int last = range.second == -1 ? pageCount : qMin(range.second, pageCount);
+        for (int number = qMax(1, range.first); number <= last; ++number) {
+            if (!pages.contains(number - 1))
+                pages.append(number - 1);
+        }
+    }
+    return pages;
+}
+
+}
@@ -0,0 +1,36 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by The Okular Developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef OKULAR_RENDERUTILS_H
+#define OKULAR_RENDERUTILS_H
+
+#include <QList>
+#include <QPair>
+#include <QString>
+
+namespace RenderUtils
+{
+/**
+ * Parses page ranges like "1-3,5,8-" into 1-based inclusive ranges, a range
+ * ending at -1 goes up to the last page.
+ *
+ * Returns false if @p text has no range or an invalid one.
+ */
+bool parsePageRanges(const QString &text, QList<QPair<int, int>> *ranges);
+
+/**
+ * Returns the 0-based numbers of the pages of @p ranges that a document of
+ * @p pageCount pages has, in the order of the ranges and without duplicates.
+ * Empty @p ranges means all the pages.
+ */
+QList<int> pagesInRanges(const QList<QPair<int, int>> &ranges, int pageCount);
+
+}
+
+#endif
@@ -12,9 +12,11 @@
 
 #include "annotationmodel.h"
 
+#include <QHash>
 #include <QLinkedList>
 #include <QList>
 #include <QPointer>
+#include <QSet>
 
 #include <KLocalizedString>
 #include <QIcon>
@@ -25,6 +27,8 @@
 #include "core/page.h"
 #include "ui/guiutils.h"
 
+#include <algorithm>
+
 struct AnnItem {
     AnnItem();
     AnnItem(AnnItem *parent, Okular::Annotation *ann);
@@ -114,16 +118,25 @@ AnnotationModelPrivate::~AnnotationModelPrivate()
     delete root;
 }
 
-static void updateAnnotationPointer(AnnItem *item, const QVector<Okular::Page *> &pages)
+static void updateAnnotationPointers(AnnItem *root, const QVector<Okular::Page *> &pages)
 {
-    if (item->annotation) {
-        item->annotation = pages[item->page]->annotation(item->annotation->uniqueName());
-        if (!item->annotation)
-            qWarning() << "Lost annotation on document save, something went wrong";
-    }
+    for (AnnItem *pageItem : qAsConst(root->children)) {
+        // index the annotations of the page by unique name, instead of
+        // looking for each one of them in all the annotations of the page
+        QHash<QString, Okular::Annotation *> pageAnnotations;
+        const QLinkedList<Okular::Annotation *> annots = pages[pageItem->page]->annotations();
+        for (Okular::Annotation *annotation : annots) {
+            pageAnnotations.insert(annotation->uniqueName(), annotation);
+        }
 
-    for (AnnItem *child : qAsConst(item->children)) {
-        updateAnnotationPointer(child, pages);
+        for (AnnItem *item : qAsConst(pageItem->children)) {
+            // an annotation lost on a previous save has nothing to look for
+            if (item->annotation) {
+                item->annotation = pageAnnotations.value(item->annotation->uniqueName());
+                if (!item->annotation)
+                    qWarning() << "Lost annotation on document save, something went wrong";
+            }
+        }
     }
 }
 
@@ -135,7 +148,7 @@ void AnnotationModelPrivate::notifySetup(const QVector<Okular::Page *> &pages, i
             // need to update all the Annotation* otherwise
             // they still point to the old document ones, luckily the old ones are still
             // around so we can look for the new ones using unique ids, etc
-            updateAnnotationPointer(root, pages);
+            updateAnnotationPointers(root, pages);
         }
         return;
     }
@@ -171,9 +184,7 @@ void AnnotationModelPrivate::notifyPageChanged(int page, int flags)
     // case 2: no existing branch
     //         => add a new branch, and add the annotations for the page
     if (!annItem) {
-        int i = 0;
-        while (i < root->children.count() && root->children.at(i)->page < page)
-            ++i;
+        const int i = std::lower_bound(root->children.constBegin(), root->children.constEnd(), page, [](const AnnItem *item, int page) { return item->page < page; }) - root->children.constBegin();
 
         AnnItem *annItem = new AnnItem();
         annItem->page = page;
@@ -181,68 +192,72 @@ void AnnotationModelPrivate::notifyPageChanged(int page, int flags)
         q->beginInsertRows(indexForItem(root), i, i);
         annItem->parent->children.insert(i, annItem);
         q->endInsertRows();
+        q->beginInsertRows(indexForItem(annItem), 0, annots.count() - 1);
         QLinkedList<Okular::Annotation *>::ConstIterator it = annots.begin(), itEnd = annots.end();
-        int newid = 0;
-        for (; it != itEnd; ++it, ++newid) {
-            q->beginInsertRows(indexForItem(annItem), newid, newid);
+        for (; it != itEnd; ++it) {
             new AnnItem(annItem, *it);
-            q->endInsertRows();
         }
+        q->endInsertRows();
         return;
     }
-    // case 3: existing branch, less annotations than items
-    //         => lookup and remove the annotations
-    if (annItem->children.count() > annots.count()) {
-        for (int i = annItem->children.count(); i > 0; --i) {
-            Okular::Annotation *ref = annItem->children.at(i - 1)->annotation;
-            bool found = false;
-            QLinkedList<Okular::Annotation *>::ConstIterator it = annots.begin(), itEnd = annots.end();
-            for (; !found && it != itEnd; ++it) {
-                if ((*it) == ref)
-                    found = true;
-            }
-            if (!found) {
-                q->beginRemoveRows(indexForItem(annItem), i - 1, i - 1);
-                delete annItem->children.at(i - 1);
-                annItem->children.removeAt(i - 1);
-                q->endRemoveRows();
-            }
+    // case 3: existing branch
+    //         => remove the items of the annotations that are gone, and add
+    //            the annotations that are not in the branch
+    QSet<Okular::Annotation *> annotsSet;
+    for (Okular::Annotation *ref : annots) {
+        annotsSet.insert(ref);
+    }
+    QSet<Okular::Annotation *> itemsSet;
+    bool changed = false;
+    for (int i = annItem->children.count(); i > 0; --i) {
+        Okular::Annotation *ref = annItem->children.at(i - 1)->annotation;
+        if (annotsSet.contains(ref)) {
+            itemsSet.insert(ref);
+            continue;
         }
-        return;
+        // remove consecutive rows at once
+        int first = i - 1;
+        while (first > 0 && !annotsSet.contains(annItem->children.at(first - 1)->annotation))
+            --first;
+        q->beginRemoveRows(indexForItem(annItem), first, i - 1);
+        for (int j = i - 1; j >= first; --j) {
+            delete annItem->children.at(j);
+            annItem->children.removeAt(j);
+        }
+        q->endRemoveRows();
+        i = first + 1;
+        changed = true;
     }
-    // case 4: existing branch, less items than annotations
-    //         => lookup and add annotations if not in the branch
-    if (annots.count() > annItem->children.count()) {
-        QLinkedList<Okular::Annotation *>::ConstIterator it = annots.begin(), itEnd = annots.end();
-        for (; it != itEnd; ++it) {
-            Okular::Annotation *ref = *it;
-            bool found = false;
-            int count = annItem->children.count();
-            for (int i = 0; !found && i < count; ++i) {
-                if (ref == annItem->children.at(i)->annotation)
-                    found = true;
-            }
-            if (!found) {
-                q->beginInsertRows(indexForItem(annItem), count, count);
-                new AnnItem(annItem, ref);
-                q->endInsertRows();
-            }
+    QList<Okular::Annotation *> added;
+    for (Okular::Annotation *ref : annots) {
+        if (!itemsSet.contains(ref))
+            added.append(ref);
+    }
+    if (!added.isEmpty()) {
+        const int count = annItem->children.count();
+        q->beginInsertRows(indexForItem(annItem), count, count + added.count() - 1);
+        for (Okular::Annotation *ref : qAsConst(added)) {
+            new AnnItem(annItem, ref);
         }
-        return;
+        q->endInsertRows();
+        changed = true;
     }
-    // case 5: the data of some annotation changed
+    if (changed)
+        return;
+    // case 4: the data of some annotation changed
     // TODO: what do we do in this case?
     // FIXME: for now, update ALL the annotations for that page
-    for (int i = 0; i < annItem->children.count(); ++i) {
-        QModelIndex index = indexForItem(annItem->children.at(i));
-        emit q->dataChanged(index, index);
-    }
+    emit q->dataChanged(indexForItem(annItem->children.first()), indexForItem(annItem->children.last()));
 }
 
 QModelIndex AnnotationModelPrivate::indexForItem(AnnItem *item) const
 {
     if (item->parent) {
-        int id = item->parent->children.indexOf(item);
+        int id = -1;
+        if (item->parent == root)
+            findItem(item->page, &id);
+        else
+            id = item->parent->children.indexOf(item);
         if (id >= 0 && id < item->parent->children.count())
             return q->createIndex(id, 0, item);
     }
@@ -251,10 +266,6 @@ QModelIndex AnnotationModelPrivate::indexForItem(AnnItem *item) const
 
 void AnnotationModelPrivate::rebuildTree(const QVector<Okular::Page *> &pages)
 {
-    if (pages.isEmpty())
-        return;
-
-    emit q->layoutAboutToBeChanged();
     for (int i = 0; i < pages.count(); ++i) {
         const QLinkedList<Okular::Annotation *> annots = filterOutWidgetAnnotations(pages.at(i)->annotations());
         if (annots.isEmpty())
@@ -266,18 +277,16 @@ void AnnotationModelPrivate::rebuildTree(const QVector<Okular::Page *> &pages)
             new AnnItem(annItem, *it);
         }
     }
-    emit q->layoutChanged();
 }
 
 AnnItem *AnnotationModelPrivate::findItem(int page, int *index) const
 {
-    for (int i = 0; i < root->children.count(); ++i) {
-        AnnItem *tmp = root->children.at(i);
-        if (tmp->page == page) {
-            if (index)
-                *index = i;
-            return tmp;
-        }
+    // the page items are sorted by page
+    QList<AnnItem *>::const_iterator it = std::lower_bound(root->children.constBegin(), root->children.constEnd(), page, [](const AnnItem *item, int page) { return item->page < page; });
+    if (it != root->children.constEnd() && (*it)->page == page) {
+        if (index)
+            *index = it - root->children.constBegin();
+        return *it;
     }
     if (index)
         *index = -1;
@@ -189,6 +189,7 @@ private:
 // Qt::SubWindow is needed to make QSizeGrip work
 AnnotWindow::AnnotWindow(QWidget *parent, Okular::Annotation *annot, Okular::Document *document, int page)
     : QFrame(parent, Qt::SubWindow)
+    , m_latexFontSize(0)
     , m_annot(annot)
     , m_document(document)
     , m_page(page)
@@ -230,6 +231,7 @@ AnnotWindow::AnnotWindow(QWidget *parent, Okular::Annotation *annot, Okular::Doc
     lowerlay->addWidget(sb);
 
     m_latexRenderer = new GuiUtils::LatexRenderer();
+    connect(m_latexRenderer, &GuiUtils::LatexRenderer::latexRendered, this, &AnnotWindow::slotLatexRendered);
     // The emit below is not wrong even if emitting signals from the constructor it's usually wrong
     // in this case the signal it's connected to inside MovableTitle constructor a few lines above
     emit containsLatex(GuiUtils::LatexRenderer::mightContainLatex(m_annot->contents())); // clazy:exclude=incorrect-emit
@@ -361,42 +363,23 @@ void AnnotWindow::slotsaveWindowText()
 void AnnotWindow::renderLatex(bool render)
 {
     if (render) {
+        // use the font of the plain text, also when rendering again with the formulas rendered meanwhile
+        if (!textEdit->acceptRichText()) {
+            m_latexFontColor = textEdit->textColor();
+            m_latexFontSize = textEdit->fontPointSize();
+        }
         textEdit->setReadOnly(true);
         disconnect(textEdit, &KTextEdit::textChanged, this, &AnnotWindow::slotsaveWindowText);
         disconnect(textEdit, &KTextEdit::cursorPositionChanged, this, &AnnotWindow::slotsaveWindowText);
         textEdit->setAcceptRichText(true);
         QString contents = m_annot->contents();
         contents = Qt::convertFromPlainText(contents);
-        QColor fontColor = textEdit->textColor();
-        int fontSize = textEdit->fontPointSize();
-        QString latexOutput;
-        GuiUtils::LatexRenderer::Error errorCode = m_latexRenderer->renderLatexInHtml(contents, fontColor, fontSize, Okular::Utils::realDpi(nullptr).width(), latexOutput);
-        switch (errorCode) {
-        case GuiUtils::LatexRenderer::LatexNotFound:
-            KMessageBox::sorry(this, i18n("Cannot find latex executable."), i18n("LaTeX rendering failed"));
-            m_title->uncheckLatexButton();
-            renderLatex(false);
-            break;
-        case GuiUtils::LatexRenderer::DvipngNotFound:
-            KMessageBox::sorry(this, i18n("Cannot find dvipng executable."), i18n("LaTeX rendering failed"));
-            m_title->uncheckLatexButton();
-            renderLatex(false);
-            break;
-        case GuiUtils::LatexRenderer::LatexFailed:
-            KMessageBox::detailedSorry(this, i18n("A problem occurred during the execution of the 'latex' command."), latexOutput, i18n("LaTeX rendering failed"));
-            m_title->uncheckLatexButton();
-            renderLatex(false);
-            break;
-        case GuiUtils::LatexRenderer::DvipngFailed:
-            KMessageBox::sorry(this, i18n("A problem occurred during the execution of the 'dvipng' command."), i18n("LaTeX rendering failed"));
-            m_title->uncheckLatexButton();
-            renderLatex(false);
-            break;
-        case GuiUtils::LatexRenderer::NoError:
-        default:
+        // the formulas that are not rendered yet are shown as text until slotLatexRendered()
+        GuiUtils::LatexRenderer::Error errorCode = m_latexRenderer->renderLatexInHtml(contents, m_latexFontColor, m_latexFontSize, Okular::Utils::realDpi(nullptr).width());
+        if (errorCode == GuiUtils::LatexRenderer::NoError)
             textEdit->setHtml(contents);
-            break;
-        }
+        else
+            showLatexError(errorCode, QString());
     } else {
         textEdit->setAcceptRichText(false);
         textEdit->setPlainText(m_annot->contents());
@@ -406,6 +389,41 @@ void AnnotWindow::renderLatex(bool render)
     }
 }
 
+void AnnotWindow::showLatexError(GuiUtils::LatexRenderer::Error errorCode, const QString &latexOutput)
+{
+    switch (errorCode) {
+    case GuiUtils::LatexRenderer::LatexNotFound:
+        KMessageBox::sorry(this, i18n("Cannot find latex executable."), i18n("LaTeX rendering failed"));
+        break;
+    case GuiUtils::LatexRenderer::DvipngNotFound:
+        KMessageBox::sorry(this, i18n("Cannot find dvipng executable."), i18n("LaTeX rendering failed"));
+        break;
+    case GuiUtils::LatexRenderer::LatexFailed:
+        KMessageBox::detailedSorry(this, i18n("A problem occurred during the execution of the 'latex' command."), latexOutput, i18n("LaTeX rendering failed"));
+        break;
+    case GuiUtils::LatexRenderer::DvipngFailed:
+        KMessageBox::sorry(this, i18n("A problem occurred during the execution of the 'dvipng' command."), i18n("LaTeX rendering failed"));
+        break;
+    case GuiUtils::LatexRenderer::NoError:
+    default:
+        return;
+    }
+    m_title->uncheckLatexButton();
+    renderLatex(false);
+}
+
+void AnnotWindow::slotLatexRendered(GuiUtils::LatexRenderer::Error errorCode, const QString &latexOutput)
+{
+    // nothing to update if the plain text is shown meanwhile
+    if (!textEdit->acceptRichText())
+        return;
+
+    if (errorCode == GuiUtils::LatexRenderer::NoError)
+        renderLatex(true);
+    else
+        showLatexError(errorCode, latexOutput);
+}
+
 void AnnotWindow::slotHandleContentsChangedByUndoRedo(Okular::Annotation *annot, const QString &contents, int cursorPos, int anchorPos)
 {
     if (annot != m_annot) {
@@ -17,17 +17,14 @@
 #include <QColor>
 #include <QFrame>
 
+#include "latexrenderer.h"
+
 namespace Okular
 {
 class Annotation;
 class Document;
 }
 
-namespace GuiUtils
-{
-class LatexRenderer;
-}
-
 class KTextEdit;
 class MovableTitle;
 class QMenu;
@@ -51,6 +48,8 @@ private:
     KTextEdit *textEdit;
     QColor m_color;
     GuiUtils::LatexRenderer *m_latexRenderer;
+    QColor m_latexFontColor;
+    int m_latexFontSize;
     Okular::Annotation *m_annot;
     Okular::Document *m_document;
     int m_page;
@@ -64,11 +63,15 @@ protected:
     void showEvent(QShowEvent *event) override;
     bool eventFilter(QObject *obj, QEvent *event) override;
 
+private:
+    void showLatexError(GuiUtils::LatexRenderer::Error errorCode, const QString &latexOutput);
+
 private Q_SLOTS:
     void slotUpdateUndoAndRedoInContextMenu(QMenu *menu);
     void slotOptionBtn();
     void slotsaveWindowText();
     void slotHandleContentsChangedByUndoRedo(Okular::Annotation *annot, const QString &contents, int cursorPos, int anchorPos);
+    void slotLatexRendered(GuiUtils::LatexRenderer::Error errorCode, const QString &latexOutput);
 
 Q_SIGNALS:
     void containsLatex(bool);
@@ -17,30 +17,185 @@
 #include <KProcess>
 
 #include <QColor>
+#include <QCryptographicHash>
 #include <QDir>
 #include <QFileInfo>
 #include <QImage>
+#include <QMap>
 #include <QRegularExpression>
+#include <QRunnable>
 #include <QStandardPaths>
 #include <QTemporaryFile>
 #include <QTextStream>
+#include <QThreadPool>
 
 #include "debug_ui.h"
 
+// the cached formula images are pruned to this total size, in bytes
+#define LATEX_CACHE_MAXSIZE (32 * 1024 * 1024)
+
 namespace GuiUtils
 {
-LatexRenderer::LatexRenderer()
+// the formulas are rendered by latex and dvipng processes, started from these threads
+Q_GLOBAL_STATIC(QThreadPool, latexRenderPool)
+
+static QString cacheDirectory()
 {
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/latex");
 }
 
-LatexRenderer::~LatexRenderer()
+static QString cacheFileName(const QString &latexFormula, const QColor &textColor, int fontSize, int resolution)
 {
-    for (const QString &file : qAsConst(m_fileList)) {
-        QFile::remove(file);
+    const QString key = QStringLiteral("%1\n%2\n%3\n%4").arg(latexFormula, textColor.name(), QString::number(fontSize), QString::number(resolution));
+    const QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return cacheDirectory() + QLatin1Char('/') + QString::fromLatin1(hash) + QStringLiteral(".png");
+}
+
+// removes the oldest cached formula images, until they take LATEX_CACHE_MAXSIZE at most
+static void pruneCache()
+{
+    const QFileInfoList files = QDir(cacheDirectory()).entryInfoList({QStringLiteral("*.png")}, QDir::Files, QDir::Time);
+    qint64 size = 0;
+    for (const QFileInfo &file : files) {
+        size += file.size();
+        if (size > LATEX_CACHE_MAXSIZE)
+            QFile::remove(file.absoluteFilePath());
     }
 }
 
-LatexRenderer::Error LatexRenderer::renderLatexInHtml(QString &html, const QColor &textColor, int fontSize, int resolution, QString &latexOutput)
+// renders all the formulas in a single latex run, one per page, and stores page i in fileNames[i]
+static LatexRenderer::Error renderFormulas(const QStringList &latexFormulas, const QStringList &fileNames, const QColor &textColor, int fontSize, int resolution, QString &latexOutput)
+{
+    KProcess latexProc;
+    KProcess dvipngProc;
+
+    QTemporaryFile *tempFile = new QTemporaryFile(QDir::tempPath() + QLatin1String("/okular_kdelatex-XXXXXX.tex"));
+    tempFile->open();
+    QString tempFileName = tempFile->fileName();
+    QFileInfo *tempFileInfo = new QFileInfo(tempFileName);
+    QString tempFileNameNS = tempFileInfo->absolutePath() + '/' + tempFileInfo->baseName();
+    QString tempFilePath = tempFileInfo->absolutePath();
+    delete tempFileInfo;
+    QTextStream tempStream(tempFile);
+
+    tempStream << "\\documentclass[" << fontSize
+               << "pt]{article} \
+\\usepackage{color} \
+\\usepackage{amsmath,latexsym,amsfonts,amssymb,ulem} \
+\\pagestyle{empty} \
+\\begin{document} ";
+    for (const QString &latexFormula : latexFormulas) {
+        tempStream << "{\\color[rgb]{" << textColor.redF() << "," << textColor.greenF() << "," << textColor.blueF() << "} \
+\\begin{eqnarray*} \
+" << latexFormula
+                   << " \
+\\end{eqnarray*}} \
+\\newpage ";
+    }
+    tempStream << "\\end{document}";
+
+    tempFile->close();
+    QString latexExecutable = QStandardPaths::findExecutable(QStringLiteral("latex"));
+    if (latexExecutable.isEmpty()) {
+        qCDebug(OkularUiDebug) << "Could not find latex!";
+        delete tempFile;
+        return LatexRenderer::LatexNotFound;
+    }
+    latexProc << latexExecutable << QStringLiteral("-interaction=nonstopmode") << QStringLiteral("-halt-on-error") << QStringLiteral("-output-directory=%1").arg(tempFilePath) << tempFile->fileName();
+    latexProc.setOutputChannelMode(KProcess::MergedChannels);
+    latexProc.execute();
+    latexOutput = QString::fromLocal8Bit(latexProc.readAll());
+    tempFile->remove();
+
+    QFile::remove(tempFileNameNS + QStringLiteral(".log"));
+    QFile::remove(tempFileNameNS + QStringLiteral(".aux"));
+    delete tempFile;
+
+    if (!QFile::exists(tempFileNameNS + QStringLiteral(".dvi"))) {
+        return LatexRenderer::LatexFailed;
+    }
+
+    QString dvipngExecutable = QStandardPaths::findExecutable(QStringLiteral("dvipng"));
+    if (dvipngExecutable.isEmpty()) {
+        qCDebug(OkularUiDebug) << "Could not find dvipng!";
+        QFile::remove(tempFileNameNS + QStringLiteral(".dvi"));
+        return LatexRenderer::DvipngNotFound;
+    }
+
+    // dvipng replaces %d with the page number
+    dvipngProc << dvipngExecutable << QStringLiteral("-o%1").arg(tempFileNameNS + QStringLiteral("-%d.png")) << QStringLiteral("-Ttight") << QStringLiteral("-bgTransparent") << QStringLiteral("-D %1").arg(resolution)
+               << QStringLiteral("%1").arg(tempFileNameNS + QStringLiteral(".dvi"));
+    dvipngProc.setOutputChannelMode(KProcess::MergedChannels);
+    dvipngProc.execute();
+
+    QFile::remove(tempFileNameNS + QStringLiteral(".dvi"));
+
+    LatexRenderer::Error error = LatexRenderer::NoError;
+    for (int i = 0; i < fileNames.count(); ++i) {
+        const QString pngFileName = tempFileNameNS + QStringLiteral("-%1.png").arg(i + 1);
+        if (!QFile::exists(pngFileName)) {
+            error = LatexRenderer::DvipngFailed;
+            continue;
+        }
+
+        // another window may have cached the same formula meanwhile
+        const QString &fileName = fileNames.at(i);
+        QDir().mkpath(QFileInfo(fileName).absolutePath());
+        QFile::remove(fileName);
+        if (!QFile::rename(pngFileName, fileName)) {
+            QFile::remove(pngFileName);
+            error = LatexRenderer::DvipngFailed;
+        }
+    }
+    return error;
+}
+
+class LatexRenderJob : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    LatexRenderJob(const QStringList &latexFormulas, const QStringList &fileNames, const QColor &textColor, int fontSize, int resolution)
+        : m_latexFormulas(latexFormulas)
+        , m_fileNames(fileNames)
+        , m_textColor(textColor)
+        , m_fontSize(fontSize)
+        , m_resolution(resolution)
+    {
+        // deleted from the thread it belongs to, once finished() was emitted
+        setAutoDelete(false);
+    }
+
+    void run() override
+    {
+        QString latexOutput;
+        const LatexRenderer::Error error = renderFormulas(m_latexFormulas, m_fileNames, m_textColor, m_fontSize, m_resolution, latexOutput);
+        pruneCache();
+        emit finished(error, latexOutput);
+    }
+
+Q_SIGNALS:
+    void finished(int error, const QString &latexOutput);
+
+private:
+    const QStringList m_latexFormulas;
+    const QStringList m_fileNames;
+    const QColor m_textColor;
+    const int m_fontSize;
+    const int m_resolution;
+};
+
+LatexRenderer::LatexRenderer(QObject *parent)
+    : QObject(parent)
+    , m_renderJobRunning(false)
+{
+}
+
+LatexRenderer::~LatexRenderer()
+{
+}
+
+LatexRenderer::Error LatexRenderer::renderLatexInHtml(QString &html, const QColor &textColor, int fontSize, int resolution)
 {
     if (!html.contains(QStringLiteral("$$")))
         return NoError;
@@ -50,6 +205,8 @@ LatexRenderer::Error LatexRenderer::renderLatexInHtml(QString &html, const QColo
     QRegularExpressionMatchIterator it = rg.globalMatch(html);
 
     QMap<QString, QString> replaceMap;
+    QStringList missingFormulas;
+    QStringList missingFileNames;
     while (it.hasNext()) {
         QRegularExpressionMatch match = it.next();
         const QString matchedString = match.captured(0);
@@ -71,16 +228,35 @@ LatexRenderer::Error LatexRenderer::renderLatexInHtml(QString &html, const QColo
         formul.replace(QLatin1String("&apos;"), QLatin1String("\'"));
         formul.replace(QLatin1String("<br>"), QLatin1String(" "));
 
-        QString fileName;
-        Error returnCode = handleLatex(fileName, formul, textColor, fontSize, resolution, latexOutput);
-        if (returnCode != NoError) {
-            return returnCode;
+        const QString fileName = cacheFileName(formul, textColor, fontSize, resolution);
+        if (QFile::exists(fileName)) {
+            replaceMap[matchedString] = fileName;
+        } else if (!missingFileNames.contains(fileName)) {
+            missingFormulas << formul;
+            missingFileNames << fileName;
+        }
+    }
+
+    // the formulas that are not cached stay as they are until they are rendered
+    if (!missingFormulas.isEmpty() && !m_renderJobRunning) {
+        // report the missing tools right away
+        if (QStandardPaths::findExecutable(QStringLiteral("latex")).isEmpty()) {
+            qCDebug(OkularUiDebug) << "Could not find latex!";
+            return LatexNotFound;
+        }
+        if (QStandardPaths::findExecutable(QStringLiteral("dvipng")).isEmpty()) {
+            qCDebug(OkularUiDebug) << "Could not find dvipng!";
+            return DvipngNotFound;
         }
 
-        replaceMap[matchedString] = fileName;
+        LatexRenderJob *job = new LatexRenderJob(missingFormulas, missingFileNames, textColor, fontSize, resolution);
+        connect(job, &LatexRenderJob::finished, this, &LatexRenderer::slotRenderJobFinished);
+        connect(job, &LatexRenderJob::finished, job, &QObject::deleteLater);
+        m_renderJobRunning = true;
+        latexRenderPool->start(job);
     }
 
-    if (replaceMap.isEmpty()) // we haven't found any LaTeX strings
+    if (replaceMap.isEmpty()) // we haven't found any cached LaTeX strings
         return NoError;
 
     int imagePxWidth, imagePxHeight;
@@ -98,6 +274,12 @@ LatexRenderer::Error LatexRenderer::renderLatexInHtml(QString &html, const QColo
     return NoError;
 }
 
+void LatexRenderer::slotRenderJobFinished(int error, const QString &latexOutput)
+{
+    m_renderJobRunning = false;
+    emit latexRendered(static_cast<Error>(error), latexOutput);
+}
+
 bool LatexRenderer::mightContainLatex(const QString &text)
 {
     if (!text.contains(QStringLiteral("$$")))
@@ -111,82 +293,6 @@ bool LatexRenderer::mightContainLatex(const QString &text)
     return true;
 }
 
-LatexRenderer::Error LatexRenderer::handleLatex(QString &fileName, const QString &latexFormula, const QColor &textColor, int fontSize, int resolution, QString &latexOutput)
-{
-    KProcess latexProc;
-    KProcess dvipngProc;
-
-    QTemporaryFile *tempFile = new QTemporaryFile(QDir::tempPath() + QLatin1String("/okular_kdelatex-XXXXXX.tex"));
-    tempFile->open();
-    QString tempFileName = tempFile->fileName();
-    QFileInfo *tempFileInfo = new QFileInfo(tempFileName);
-    QString tempFileNameNS = tempFileInfo->absolutePath() + '/' + tempFileInfo->baseName();
-    QString tempFilePath = tempFileInfo->absolutePath();
-    delete tempFileInfo;
-    QTextStream tempStream(tempFile);
-
-    tempStream << "\
-\\documentclass["
-               << fontSize << "pt]{article} \
-\\usepackage{color} \
-\\usepackage{amsmath,latexsym,amsfonts,amssymb,ulem} \
-\\pagestyle{empty} \
-\\begin{document} \
-{\\color[rgb]{" << textColor.redF()
-               << "," << textColor.greenF() << "," << textColor.blueF() << "} \
-\\begin{eqnarray*} \
-" << latexFormula
-               << " \
-\\end{eqnarray*}} \
-\\end{document}";
-
-    tempFile->close();
-    QString latexExecutable = QStandardPaths::findExecutable(QStringLiteral("latex"));
-    if (latexExecutable.isEmpty()) {
-        qCDebug(OkularUiDebug) << "Could not find latex!";
-        delete tempFile;
-        fileName = QString();
-        return LatexNotFound;
-    }
-    latexProc << latexExecutable << QStringLiteral("-interaction=nonstopmode") << QStringLiteral("-halt-on-error") << QStringLiteral("-output-directory=%1").arg(tempFilePath) << tempFile->fileName();
-    latexProc.setOutputChannelMode(KProcess::MergedChannels);
-    latexProc.execute();
-    latexOutput = QString::fromLocal8Bit(latexProc.readAll());
-    tempFile->remove();
-
-    QFile::remove(tempFileNameNS + QStringLiteral(".log"));
-    QFile::remove(tempFileNameNS + QStringLiteral(".aux"));
-    delete tempFile;
-
-    if (!QFile::exists(tempFileNameNS + QStringLiteral(".dvi"))) {
-        fileName = QString();
-        return LatexFailed;
-    }
-
-    QString dvipngExecutable = QStandardPaths::findExecutable(QStringLiteral("dvipng"));
-    if (dvipngExecutable.isEmpty()) {
-        qCDebug(OkularUiDebug) << "Could not find dvipng!";
-        fileName = QString();
-        return DvipngNotFound;
-    }
-
-    dvipngProc << dvipngExecutable << QStringLiteral("-o%1").arg(tempFileNameNS + QStringLiteral(".png")) << QStringLiteral("-Ttight") << QStringLiteral("-bgTransparent") << QStringLiteral("-D %1").arg(resolution)
-               << QStringLiteral("%1").arg(tempFileNameNS + QStringLiteral(".dvi"));
-    dvipngProc.setOutputChannelMode(KProcess::MergedChannels);
-    dvipngProc.execute();
-
-    QFile::remove(tempFileNameNS + QStringLiteral(".dvi"));
-
-    if (!QFile::exists(tempFileNameNS + QStringLiteral(".png"))) {
-        fileName = QString();
-        return DvipngFailed;
-    }
-
-    fileName = tempFileNameNS + QStringLiteral(".png");
-    m_fileList << fileName;
-    return NoError;
-}
-
 bool LatexRenderer::securityCheck(const QString &latexFormula)
 {
     return !latexFormula.contains(
@@ -197,3 +303,5 @@ bool LatexRenderer::securityCheck(const QString &latexFormula)
 }
 
 }
+
+#include "latexrenderer.moc"
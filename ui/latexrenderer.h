@@ -13,32 +13,51 @@
 #ifndef LATEXRENDERER_H
 #define LATEXRENDERER_H
 
-#include <QStringList>
+#include <QObject>
 
 class QString;
 class QColor;
 
 namespace GuiUtils
 {
-class LatexRenderer
+class LatexRenderer : public QObject
 {
+    Q_OBJECT
+
 public:
     enum Error { NoError, LatexNotFound, DvipngNotFound, LatexFailed, DvipngFailed };
 
-    LatexRenderer();
-    ~LatexRenderer();
+    explicit LatexRenderer(QObject *parent = nullptr);
+    ~LatexRenderer() override;
 
     LatexRenderer(const LatexRenderer &) = delete;
     LatexRenderer &operator=(const LatexRenderer &) = delete;
 
-    Error renderLatexInHtml(QString &html, const QColor &textColor, int fontSize, int resolution, QString &latexOutput);
+    /**
+     * Replaces the $$formulas$$ of @p html with their images.
+     *
+     * The images are cached on disk, the formulas that are not cached yet are
+     * left as they are and rendered in the background, all of them in a single
+     * LaTeX run. latexRendered() is emitted once they are done. After each run
+     * the oldest images are removed from the cache if it grew too large.
+     */
+    Error renderLatexInHtml(QString &html, const QColor &textColor, int fontSize, int resolution);
     static bool mightContainLatex(const QString &text);
 
+Q_SIGNALS:
+    /**
+     * The formulas missing in the last renderLatexInHtml() call were rendered,
+     * calling it again replaces them with their images.
+     */
+    void latexRendered(GuiUtils::LatexRenderer::Error error, const QString &latexOutput);
+
+private Q_SLOTS:
+    void slotRenderJobFinished(int error, const QString &latexOutput);
+
 private:
-    Error handleLatex(QString &fileName, const QString &latexFormula, const QColor &textColor, int fontSize, int resolution, QString &latexOutput);
     static bool securityCheck(const QString &latexFormula);
 
-    QStringList m_fileList;
+    bool m_renderJobRunning;
 };
 
 }
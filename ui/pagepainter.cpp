@@ -22,6 +22,7 @@
 #include <QVarLengthArray>
 
 // system includes
+#include <algorithm>
 #include <math.h>
 
 // local includes
@@ -30,6 +31,7 @@
 #include "core/observer.h"
 #include "core/page.h"
 #include "core/page_p.h"
+#include "core/rendertrace_p.h"
 #include "core/tile.h"
 #include "core/utils.h"
 #include "guiutils.h"
@@ -41,6 +43,27 @@ Q_GLOBAL_STATIC_WITH_ARGS(QPixmap, busyPixmap, (KIconLoader::global()->loadIcon(
 
 #define TEXTANNOTATION_ICONSIZE 24
 
+// upper bounds of the cached annotation layers, in bytes for all of them
+// and in pixels for a single one
+#define ANNOTATIONLAYERS_MAXMEMORY (128 * 1024 * 1024)
+#define ANNOTATIONLAYER_MAXPIXELS (8 * 1024 * 1024)
+
+namespace
+{
+struct AnnotationLayer {
+    const Okular::Page *page;
+    const Okular::DocumentObserver *observer;
+    QSize size;
+    QRect crop;
+    Okular::Rotation rotation;
+    int annotationsRevision;
+    QImage image;
+};
+}
+
+// the least recently used layer comes first
+Q_GLOBAL_STATIC(QList<AnnotationLayer>, annotationLayers)
+
 inline QPen buildPen(const Okular::Annotation *ann, double width, const QColor &color)
 {
     QColor c = color;
@@ -64,6 +87,7 @@ void PagePainter::paintCroppedPageOnPainter(QPainter *destPainter,
                                             const Okular::NormalizedRect &crop,
                                             Okular::NormalizedPoint *viewPortPoint)
 {
+    const Okular::RenderTrace::Scope traceScope("paint", page->number());
     qreal dpr = destPainter->device()->devicePixelRatioF();
 
     /* Calculate the cropped geometry of the page */
@@ -105,6 +129,7 @@ void PagePainter::paintCroppedPageOnPainter(QPainter *destPainter,
     if (!hasTilesManager) {
         /** 1 - RETRIEVE THE 'PAGE+ID' PIXMAP OR A SIMILAR 'PAGE' ONE **/
         const QPixmap *p = page->_o_nearestPixmap(observer, dScaledWidth, dScaledHeight);
+        Okular::RenderTrace::recordCacheLookup(p && p->width() == dScaledWidth && p->height() == dScaledHeight);
 
         if (p != nullptr) {
             pixmap = *p;
@@ -242,6 +267,8 @@ void PagePainter::paintCroppedPageOnPainter(QPainter *destPainter,
         if (hasTilesManager) {
             const Okular::NormalizedRect normalizedLimits(limitsInPixmap, scaledWidth, scaledHeight);
             const QList<Okular::Tile> tiles = page->tilesAt(observer, normalizedLimits);
+            // a hit if the limits are covered by tiles of the right size only
+            bool tilesHit = !tiles.isEmpty();
             QList<Okular::Tile>::const_iterator tIt = tiles.constBegin(), tEnd = tiles.constEnd();
             while (tIt != tEnd) {
                 const Okular::Tile &tile = *tIt;
@@ -258,10 +285,12 @@ void PagePainter::paintCroppedPageOnPainter(QPainter *destPainter,
                         destPainter->drawPixmap(limitsInTile.topLeft(), *tilePixmap, dLimitsInTile.translated(-dTileRect.topLeft()));
                     } else {
                         destPainter->drawPixmap(tileRect, *tilePixmap);
+                        tilesHit = false;
                     }
                 }
                 tIt++;
             }
+            Okular::RenderTrace::recordCacheLookup(tilesHit);
         } else {
             QPixmap scaledCroppedPixmap = pixmap.scaled(dScaledWidth, dScaledHeight).copy(dLimitsInPixmap);
             scaledCroppedPixmap.setDevicePixelRatio(dpr);
@@ -282,6 +311,8 @@ void PagePainter::paintCroppedPageOnPainter(QPainter *destPainter,
         if (hasTilesManager) {
             const Okular::NormalizedRect normalizedLimits(limitsInPixmap, scaledWidth, scaledHeight);
             const QList<Okular::Tile> tiles = page->tilesAt(observer, normalizedLimits);
+            // a hit if the limits are covered by tiles of the right size only
+            bool tilesHit = !tiles.isEmpty();
             QList<Okular::Tile>::const_iterator tIt = tiles.constBegin(), tEnd = tiles.constEnd();
             while (tIt != tEnd) {
                 const Okular::Tile &tile = *tIt;
@@ -297,6 +328,7 @@ void PagePainter::paintCroppedPageOnPainter(QPainter *destPainter,
                     if (tilePixmap->width() == dTileRect.width() && tilePixmap->height() == dTileRect.height()) {
                         p.drawPixmap(limitsInTile.translated(-limits.topLeft()).topLeft(), *tilePixmap, dLimitsInTile.translated(-dTileRect.topLeft()));
                     } else {
+                        tilesHit = false;
                         double xScale = tilePixmap->width() / (double)dTileRect.width();
                         double yScale = tilePixmap->height() / (double)dTileRect.height();
                         QTransform transform(xScale, 0, 0, yScale, 0, 0);
@@ -305,6 +337,7 @@ void PagePainter::paintCroppedPageOnPainter(QPainter *destPainter,
                 }
                 ++tIt;
             }
+            Okular::RenderTrace::recordCacheLookup(tilesHit);
         } else {
             // 4B.1. draw the page pixmap: normal or scaled
             QPixmap scaledCroppedPixmap = pixmap.scaled(dScaledWidth, dScaledHeight).copy(dLimitsInPixmap);
@@ -315,35 +348,8 @@ void PagePainter::paintCroppedPageOnPainter(QPainter *destPainter,
         p.end();
 
         // 4B.2. modify pixmap following accessibility settings
-        if (bufferAccessibility) {
-            switch (Okular::SettingsCore::renderMode()) {
-            case Okular::SettingsCore::EnumRenderMode::Inverted:
-                // Invert image pixels using QImage internal function
-                backImage.invertPixels(QImage::InvertRgb);
-                break;
-            case Okular::SettingsCore::EnumRenderMode::Recolor:
-                recolor(&backImage, Okular::Settings::recolorForeground(), Okular::Settings::recolorBackground());
-                break;
-            case Okular::SettingsCore::EnumRenderMode::BlackWhite:
-                blackWhite(&backImage, Okular::Settings::bWContrast(), Okular::Settings::bWThreshold());
-                break;
-            case Okular::SettingsCore::EnumRenderMode::InvertLightness:
-                invertLightness(&backImage);
-                break;
-            case Okular::SettingsCore::EnumRenderMode::InvertLuma:
-                invertLuma(&backImage, 0.2126, 0.7152, 0.0722); // sRGB / Rec. 709 luma coefficients
-                break;
-            case Okular::SettingsCore::EnumRenderMode::InvertLumaSymmetric:
-                invertLuma(&backImage, 0.3333, 0.3334, 0.3333); // Symmetric coefficients, to keep colors saturated.
-                break;
-            case Okular::SettingsCore::EnumRenderMode::HueShiftPositive:
-                hueShiftPositive(&backImage);
-                break;
-            case Okular::SettingsCore::EnumRenderMode::HueShiftNegative:
-                hueShiftNegative(&backImage);
-                break;
-            }
-        }
+        if (bufferAccessibility)
+            changeImageColors(&backImage);
 
         // 4B.3. highlight rects in page
         if (bufferedHighlights) {
@@ -379,6 +385,16 @@ void PagePainter::paintCroppedPageOnPainter(QPainter *destPainter,
             double xOffset = (double)limits.left() / (double)scaledWidth + crop.left, xScale = (double)scaledWidth / (double)limits.width(), yOffset = (double)limits.top() / (double)scaledHeight + crop.top,
                    yScale = (double)scaledHeight / (double)limits.height();
 
+            // the ink and line annotations of the whole page are painted once on
+            // a cached layer, that is composited over the highlight annotations
+            QImage layer;
+            for (const Okular::Annotation *a : qAsConst(*bufferedAnnotations)) {
+                if (a->subType() == Okular::Annotation::ALine || a->subType() == Okular::Annotation::AInk) {
+                    layer = annotationLayer(page, observer, scaledWidth, scaledHeight, crop, dpr);
+                    break;
+                }
+            }
+
             // paint all buffered annotations in the page
             QList<Okular::Annotation *>::const_iterator aIt = bufferedAnnotations->constBegin(), aEnd = bufferedAnnotations->constEnd();
             for (; aIt != aEnd; ++aIt) {
@@ -389,10 +405,10 @@ void PagePainter::paintCroppedPageOnPainter(QPainter *destPainter,
                     acolor = Qt::yellow;
                 acolor.setAlphaF(a->style().opacity());
 
-                // draw LineAnnotation MISSING: caption, dash pattern, endings for multipoint lines
-                if (type == Okular::Annotation::ALine) {
-                    LineAnnotPainter linepainter {(Okular::LineAnnotation *)a, {page->width(), page->height()}, pageScale, {xScale, 0., 0., yScale, -xOffset * xScale, -yOffset * yScale}};
-                    linepainter.draw(backImage);
+                // draw LineAnnotation and InkAnnotation, if the layer is too large to be cached
+                if (type == Okular::Annotation::ALine || type == Okular::Annotation::AInk) {
+                    if (layer.isNull())
+                        drawLayerAnnotation(backImage, a, page, pageScale, xOffset, xScale, yOffset, yScale);
                 }
                 // draw HighlightAnnotation MISSING: under/strike width, feather, capping
                 else if (type == Okular::Annotation::AHighlight) {
@@ -449,35 +465,12 @@ void PagePainter::paintCroppedPageOnPainter(QPainter *destPainter,
                         }
                     }
                 }
-                // draw InkAnnotation MISSING:invar width, PENTRACER
-                else if (type == Okular::Annotation::AInk) {
-                    // get the annotation
-                    Okular::InkAnnotation *ia = (Okular::InkAnnotation *)a;
-
-                    // draw each ink path
-                    const QList<QLinkedList<Okular::NormalizedPoint>> transformedInkPaths = ia->transformedInkPaths();
-
-                    const QPen inkPen = buildPen(a, a->style().width(), acolor);
-
-                    int paths = transformedInkPaths.size();
-                    for (int p = 0; p < paths; p++) {
-                        NormalizedPath path;
-                        const QLinkedList<Okular::NormalizedPoint> &inkPath = transformedInkPaths[p];
-
-                        // normalize page point to image
-                        QLinkedList<Okular::NormalizedPoint>::const_iterator pIt = inkPath.constBegin(), pEnd = inkPath.constEnd();
-                        for (; pIt != pEnd; ++pIt) {
-                            const Okular::NormalizedPoint &inkPoint = *pIt;
-                            Okular::NormalizedPoint point;
-                            point.x = (inkPoint.x - xOffset) * xScale;
-                            point.y = (inkPoint.y - yOffset) * yScale;
-                            path.append(point);
-                        }
-                        // draw the normalized path into image
-                        drawShapeOnImage(backImage, path, false, inkPen, QBrush(), pageScale);
-                    }
-                }
             } // end current annotation drawing
+
+            if (!layer.isNull()) {
+                QPainter painter(&backImage);
+                painter.drawImage(QRectF(0, 0, limits.width(), limits.height()), layer, QRectF(dLimits));
+            }
         }
         if (viewPortPoint) {
             QPainter painter(&backImage);
@@ -694,6 +687,37 @@ void PagePainter::paintCroppedPageOnPainter(QPainter *destPainter,
     delete unbufferedAnnotations;
 }
 
+void PagePainter::changeImageColors(QImage *image)
+{
+    switch (Okular::SettingsCore::renderMode()) {
+    case Okular::SettingsCore::EnumRenderMode::Inverted:
+        // Invert image pixels using QImage internal function
+        image->invertPixels(QImage::InvertRgb);
+        break;
+    case Okular::SettingsCore::EnumRenderMode::Recolor:
+        recolor(image, Okular::Settings::recolorForeground(), Okular::Settings::recolorBackground());
+        break;
+    case Okular::SettingsCore::EnumRenderMode::BlackWhite:
+        blackWhite(image, Okular::Settings::bWContrast(), Okular::Settings::bWThreshold());
+        break;
+    case Okular::SettingsCore::EnumRenderMode::InvertLightness:
+        invertLightness(image);
+        break;
+    case Okular::SettingsCore::EnumRenderMode::InvertLuma:
+        invertLuma(image, 0.2126, 0.7152, 0.0722); // sRGB / Rec. 709 luma coefficients
+        break;
+    case Okular::SettingsCore::EnumRenderMode::InvertLumaSymmetric:
+        invertLuma(image, 0.3333, 0.3334, 0.3333); // Symmetric coefficients, to keep colors saturated.
+        break;
+    case Okular::SettingsCore::EnumRenderMode::HueShiftPositive:
+        hueShiftPositive(image);
+        break;
+    case Okular::SettingsCore::EnumRenderMode::HueShiftNegative:
+        hueShiftNegative(image);
+        break;
+    }
+}
+
 void PagePainter::recolor(QImage *image, const QColor &foreground, const QColor &background)
 {
     if (image->format() != QImage::Format_ARGB32_Premultiplied) {
@@ -935,6 +959,113 @@ void PagePainter::hueShiftNegative(QImage *image)
     }
 }
 
+QImage PagePainter::annotationLayer(const Okular::Page *page, const Okular::DocumentObserver *observer, int scaledWidth, int scaledHeight, const Okular::NormalizedRect &crop, qreal dpr)
+{
+    const QRect scaledCrop = crop.geometry(scaledWidth, scaledHeight);
+    const QRect dScaledCrop(QRectF(scaledCrop.x() * dpr, scaledCrop.y() * dpr, scaledCrop.width() * dpr, scaledCrop.height() * dpr).toAlignedRect());
+    const QSize dScaledSize(ceil(scaledWidth * dpr), ceil(scaledHeight * dpr));
+
+    if (dScaledCrop.isEmpty() || (qint64)dScaledCrop.width() * dScaledCrop.height() > ANNOTATIONLAYER_MAXPIXELS)
+        return QImage();
+
+    QList<AnnotationLayer> &layers = *annotationLayers;
+    for (int i = layers.count() - 1; i >= 0; --i) {
+        const AnnotationLayer &layer = layers.at(i);
+        if (layer.page == page && layer.annotationsRevision == page->d->m_annotationsRevision && layer.observer == observer && layer.size == dScaledSize && layer.crop == dScaledCrop && layer.rotation == page->rotation()) {
+            layers.move(i, layers.count() - 1);
+            return layers.last().image;
+        }
+    }
+
+    QImage image(dScaledCrop.size(), QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(dpr);
+    image.fill(Qt::transparent);
+
+    // the layer covers the whole cropped page
+    const int croppedWidth = scaledCrop.width();
+    const int croppedHeight = scaledCrop.height();
+    const double pageScale = (double)croppedWidth / page->width();
+    const double xOffset = crop.left, xScale = (double)scaledWidth / (double)croppedWidth, yOffset = crop.top, yScale = (double)scaledHeight / (double)croppedHeight;
+
+    for (const Okular::Annotation *a : qAsConst(page->m_annotations)) {
+        if (a->flags() & (Okular::Annotation::Hidden | Okular::Annotation::ExternallyDrawn))
+            continue;
+        drawLayerAnnotation(image, a, page, pageScale, xOffset, xScale, yOffset, yScale);
+    }
+
+    // make room for the new layer, dropping the least recently used ones
+    qint64 memory = (qint64)image.bytesPerLine() * image.height();
+    for (const AnnotationLayer &layer : qAsConst(layers))
+        memory += (qint64)layer.image.bytesPerLine() * layer.image.height();
+    while (!layers.isEmpty() && memory > ANNOTATIONLAYERS_MAXMEMORY) {
+        memory -= (qint64)layers.first().image.bytesPerLine() * layers.first().image.height();
+        layers.removeFirst();
+    }
+
+    layers.append({page, observer, dScaledSize, dScaledCrop, page->rotation(), page->d->m_annotationsRevision, image});
+    return image;
+}
+
+void PagePainter::invalidateAnnotationLayers(const Okular::Page *page)
+{
+    if (!annotationLayers.exists())
+        return;
+
+    QList<AnnotationLayer> &layers = *annotationLayers;
+    layers.erase(std::remove_if(layers.begin(), layers.end(), [page](const AnnotationLayer &layer) { return layer.page == page; }), layers.end());
+}
+
+void PagePainter::clearAnnotationLayers(const Okular::DocumentObserver *observer)
+{
+    if (!annotationLayers.exists())
+        return;
+
+    QList<AnnotationLayer> &layers = *annotationLayers;
+    layers.erase(std::remove_if(layers.begin(), layers.end(), [observer](const AnnotationLayer &layer) { return layer.observer == observer; }), layers.end());
+}
+
+void PagePainter::drawLayerAnnotation(QImage &image, const Okular::Annotation *a, const Okular::Page *page, double pageScale, double xOffset, double xScale, double yOffset, double yScale)
+{
+    // draw LineAnnotation MISSING: caption, dash pattern, endings for multipoint lines
+    if (a->subType() == Okular::Annotation::ALine) {
+        LineAnnotPainter linepainter {static_cast<const Okular::LineAnnotation *>(a), {page->width(), page->height()}, pageScale, {xScale, 0., 0., yScale, -xOffset * xScale, -yOffset * yScale}};
+        linepainter.draw(image);
+    }
+    // draw InkAnnotation MISSING:invar width, PENTRACER
+    else if (a->subType() == Okular::Annotation::AInk) {
+        QColor acolor = a->style().color();
+        if (!acolor.isValid())
+            acolor = Qt::yellow;
+        acolor.setAlphaF(a->style().opacity());
+
+        // get the annotation
+        const Okular::InkAnnotation *ia = static_cast<const Okular::InkAnnotation *>(a);
+
+        // draw each ink path
+        const QList<QLinkedList<Okular::NormalizedPoint>> transformedInkPaths = ia->transformedInkPaths();
+
+        const QPen inkPen = buildPen(a, a->style().width(), acolor);
+
+        int paths = transformedInkPaths.size();
+        for (int p = 0; p < paths; p++) {
+            NormalizedPath path;
+            const QLinkedList<Okular::NormalizedPoint> &inkPath = transformedInkPaths[p];
+
+            // normalize page point to image
+            QLinkedList<Okular::NormalizedPoint>::const_iterator pIt = inkPath.constBegin(), pEnd = inkPath.constEnd();
+            for (; pIt != pEnd; ++pIt) {
+                const Okular::NormalizedPoint &inkPoint = *pIt;
+                Okular::NormalizedPoint point;
+                point.x = (inkPoint.x - xOffset) * xScale;
+                point.y = (inkPoint.y - yOffset) * yScale;
+                path.append(point);
+            }
+            // draw the normalized path into image
+            drawShapeOnImage(image, path, false, inkPen, QBrush(), pageScale);
+        }
+    }
+}
+
 void PagePainter::drawShapeOnImage(QImage &image, const NormalizedPath &normPath, bool closeShape, const QPen &pen, const QBrush &brush, double penWidthMultiplier, RasterOperation op
                                    // float antiAliasRadius
 )
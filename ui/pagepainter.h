@@ -71,6 +71,24 @@ public:
                                           const Okular::NormalizedRect &crop,
                                           Okular::NormalizedPoint *viewPortPoint);
 
+    /**
+     * Forget the cached annotation layers of @p page now, instead of when
+     * they are the least recently used; they aren't used anymore once its
+     * annotations changed.
+     */
+    static void invalidateAnnotationLayers(const Okular::Page *page);
+
+    /**
+     * Forget all the cached annotation layers painted for @p observer now.
+     */
+    static void clearAnnotationLayers(const Okular::DocumentObserver *observer);
+
+    /**
+     * Change the colors of @p image as the render mode of the Change Colors
+     * accessibility setting says. @p image has to be in QImage::Format_ARGB32_Premultiplied.
+     */
+    static void changeImageColors(QImage *image);
+
 private:
     // BEGIN Change Colors feature
     /**
@@ -125,6 +143,21 @@ private:
      */
     static void drawEllipseOnImage(QImage &image, const NormalizedPath &rect, const QPen &pen, const QBrush &brush, double penWidthMultiplier, RasterOperation op = Normal);
 
+    /**
+     * Returns the layer with the ink and line annotations of the cropped @p page,
+     * painted once and cached until its annotations change.
+     *
+     * Returns a null image if the layer would be too large to be cached.
+     */
+    static QImage annotationLayer(const Okular::Page *page, const Okular::DocumentObserver *observer, int scaledWidth, int scaledHeight, const Okular::NormalizedRect &crop, qreal dpr);
+
+    /**
+     * Draw the ink or line annotation @p a on @p image.
+     *
+     * @p xOffset, @p xScale, @p yOffset and @p yScale normalize page coordinates into @p image coordinates.
+     */
+    static void drawLayerAnnotation(QImage &image, const Okular::Annotation *a, const Okular::Page *page, double pageScale, double xOffset, double xScale, double yOffset, double yScale);
+
     friend class LineAnnotPainter;
 };
 
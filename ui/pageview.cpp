@@ -61,6 +61,7 @@
 #include <QIcon>
 
 // system includes
+#include <algorithm>
 #include <array>
 #include <math.h>
 #include <stdlib.h>
@@ -130,6 +131,11 @@ TableSelectionPart::TableSelectionPart(PageViewItem *item_p, const Okular::Norma
 {
 }
 
+// the scroll velocity is forgotten after a pause this long, in milliseconds
+#define SCROLL_VELOCITY_TIMEOUT 300
+// how far ahead of a scrolling view to preload, in milliseconds of scrolling
+#define PRELOAD_LOOKAHEAD_TIME 600
+
 // structure used internally by PageView for data storage
 class PageViewPrivate
 {
@@ -141,12 +147,32 @@ public:
     OkularTTS *tts();
 #endif
     QString selectedText() const;
+    // the indexes of the first and last items that can intersect with rect
+    void itemsInRect(const QRect &rect, int *first, int *last) const;
+    // scroll velocity estimation, in pixels per millisecond
+    void updateScrollVelocity(const QPoint &scrollPosition);
+    QPointF currentScrollVelocity() const;
 
     // the document, pageviewItems and the 'visible cache'
     PageView *q;
     Okular::Document *document;
     QVector<PageViewItem *> items;
     QLinkedList<PageViewItem *> visibleItems;
+    // layout index: the top of each row of items followed by the bottom of
+    // the last one, the number of columns, the column of the first item and
+    // the only row laid out when not continuous (-1 when continuous)
+    QVector<int> rowTops;
+    int layoutColumns;
+    int layoutFirstColumn;
+    int layoutCurrentRow;
+    // the scroll velocity, smoothed over the last scroll events
+    QElapsedTimer scrollVelocityTimer;
+    QPoint lastScrollPosition;
+    QPointF scrollVelocity;
+    // the items whose form and video widgets were placed in the viewport by
+    // the last pixmaps request; -1 when the widgets of all the items must be placed
+    int widgetsFirstItem;
+    int widgetsLastItem;
     MagnifierView *magnifierView;
 
     // view layout (columns and continuous in Settings), zoom and mouse
@@ -185,6 +211,7 @@ public:
     QSet<AnnotWindow *> m_annowindows;
     // other stuff
     QTimer *delayResizeEventTimer;
+    QTimer *delayZoomPixmapsRequestTimer;
     bool dirtyLayout;
     bool blockViewport;             // prevents changes to viewport
     bool blockPixmapsRequest;       // prevent pixmap requests
@@ -283,6 +310,54 @@ FormWidgetsController *PageViewPrivate::formWidgetsController()
     return formsWidgetController;
 }
 
+void PageViewPrivate::itemsInRect(const QRect &rect, int *first, int *last) const
+{
+    // no layout yet, check all of them
+    if (rowTops.isEmpty()) {
+        *first = 0;
+        *last = items.count() - 1;
+        return;
+    }
+
+    int firstRow, lastRow;
+    if (layoutCurrentRow != -1) {
+        firstRow = lastRow = layoutCurrentRow;
+    } else {
+        // the rows starting right above the top and the bottom of the rect
+        QVector<int>::const_iterator rowsEnd = rowTops.constEnd() - 1;
+        firstRow = qMax(0, int(std::upper_bound(rowTops.constBegin(), rowsEnd, rect.top()) - rowTops.constBegin()) - 1);
+        lastRow = int(std::upper_bound(rowTops.constBegin(), rowsEnd, rect.bottom()) - rowTops.constBegin()) - 1;
+    }
+
+    *first = qMax(0, firstRow * layoutColumns - layoutFirstColumn);
+    *last = qMin(items.count() - 1, (lastRow + 1) * layoutColumns - layoutFirstColumn - 1);
+}
+
+void PageViewPrivate::updateScrollVelocity(const QPoint &scrollPosition)
+{
+    // the scroll bars may move in the same millisecond, wait for the next one
+    const qint64 elapsed = scrollVelocityTimer.isValid() ? scrollVelocityTimer.elapsed() : -1;
+    if (elapsed == 0)
+        return;
+
+    // a pause starts the estimation again
+    if (elapsed < 0 || elapsed > SCROLL_VELOCITY_TIMEOUT)
+        scrollVelocity = QPointF();
+    else
+        scrollVelocity = (scrollVelocity + QPointF(scrollPosition - lastScrollPosition) / elapsed) / 2;
+
+    scrollVelocityTimer.start();
+    lastScrollPosition = scrollPosition;
+}
+
+QPointF PageViewPrivate::currentScrollVelocity() const
+{
+    if (!scrollVelocityTimer.isValid() || scrollVelocityTimer.elapsed() > SCROLL_VELOCITY_TIMEOUT)
+        return QPointF();
+
+    return scrollVelocity;
+}
+
 #ifdef HAVE_SPEECH
 OkularTTS *PageViewPrivate::tts()
 {
@@ -330,6 +405,11 @@ PageView::PageView(QWidget *parent, Okular::Document *document)
     d->mouseMode = Okular::Settings::mouseMode();
     d->mouseAnnotation = new MouseAnnotation(this, document);
     d->tableDividersGuessed = false;
+    d->layoutColumns = 1;
+    d->layoutFirstColumn = 0;
+    d->layoutCurrentRow = -1;
+    d->widgetsFirstItem = -1;
+    d->widgetsLastItem = -1;
     d->lastSourceLocationViewportPageNumber = -1;
     d->lastSourceLocationViewportNormalizedX = 0.0;
     d->lastSourceLocationViewportNormalizedY = 0.0;
@@ -407,6 +487,11 @@ PageView::PageView(QWidget *parent, Okular::Document *document)
     d->delayResizeEventTimer->setObjectName(QStringLiteral("delayResizeEventTimer"));
     connect(d->delayResizeEventTimer, &QTimer::timeout, this, &PageView::delayedResizeEvent);
 
+    d->delayZoomPixmapsRequestTimer = new QTimer(this);
+    d->delayZoomPixmapsRequestTimer->setSingleShot(true);
+    d->delayZoomPixmapsRequestTimer->setObjectName(QStringLiteral("delayZoomPixmapsRequestTimer"));
+    connect(d->delayZoomPixmapsRequestTimer, &QTimer::timeout, this, [this] { slotRequestVisiblePixmaps(); });
+
     setFrameStyle(QFrame::NoFrame);
 
     setAttribute(Qt::WA_StaticContents);
@@ -1016,6 +1101,10 @@ void PageView::notifySetup(const QVector<Okular::Page *> &pageSet, int setupFlag
     bool documentChanged = setupFlags & Okular::DocumentObserver::DocumentChanged;
     const bool allowfillforms = d->document->isAllowed(Okular::AllowFillForms);
 
+    // the pages of a new document may reuse the addresses of the old ones
+    if (documentChanged)
+        PagePainter::clearAnnotationLayers(this);
+
     // reuse current pages if nothing new
     if ((pageSet.count() == d->items.count()) && !documentChanged && !(setupFlags & Okular::DocumentObserver::NewLayoutForPages)) {
         int count = pageSet.count();
@@ -1088,6 +1177,8 @@ void PageView::notifySetup(const QVector<Okular::Page *> &pageSet, int setupFlag
     qDeleteAll(d->items);
     d->items.clear();
     d->visibleItems.clear();
+    d->rowTops.clear();
+    d->widgetsFirstItem = -1;
     d->pagesWithTextSelection.clear();
     toggleFormWidgets(false);
     if (d->formsWidgetController)
@@ -1324,6 +1415,8 @@ void PageView::notifyPageChanged(int pageNumber, int changedFlags)
         return;
 
     if (changedFlags & DocumentObserver::Annotations) {
+        PagePainter::invalidateAnnotationLayers(d->document->page(pageNumber));
+
         const QLinkedList<Okular::Annotation *> annots = d->document->page(pageNumber)->annotations();
         const QLinkedList<Okular::Annotation *>::ConstIterator annItEnd = annots.end();
         QSet<AnnotWindow *>::Iterator it = d->m_annowindows.begin();
@@ -1613,6 +1706,8 @@ bool PageView::gestureEvent(QGestureEvent *event)
 
         if (pinch->state() == Qt::GestureFinished) {
             rotations = 0;
+            // the pixmaps were not requested while zooming
+            slotRequestVisiblePixmaps();
         }
 
         return true;
@@ -3137,12 +3232,19 @@ void PageView::wheelEvent(QWheelEvent *e)
     e->accept();
     if ((e->modifiers() & Qt::ControlModifier) == Qt::ControlModifier) {
         d->controlWheelAccumulatedDelta += delta;
+        // request the pixmaps once the wheel stops, the pages are painted scaled meanwhile
         if (d->controlWheelAccumulatedDelta <= -QWheelEvent::DefaultDeltasPerStep) {
+            d->blockPixmapsRequest = true;
             slotZoomOut();
+            d->blockPixmapsRequest = false;
             d->controlWheelAccumulatedDelta = 0;
+            d->delayZoomPixmapsRequestTimer->start(100);
         } else if (d->controlWheelAccumulatedDelta >= QWheelEvent::DefaultDeltasPerStep) {
+            d->blockPixmapsRequest = true;
             slotZoomIn();
+            d->blockPixmapsRequest = false;
             d->controlWheelAccumulatedDelta = 0;
+            d->delayZoomPixmapsRequestTimer->start(100);
         }
     } else {
         d->controlWheelAccumulatedDelta = 0;
@@ -3813,6 +3915,8 @@ void PageView::updateZoom(ZoomMode newZoomMode)
         newFactor = 0.1;
 
     if (newZoomMode != d->zoomMode || (newZoomMode == ZoomFixed && newFactor != d->zoomFactor)) {
+        // the pixmaps requested for the previous zoom level are stale
+        d->document->supersedePixmapRequests(this);
         // rebuild layout and update the whole viewport
         d->zoomMode = newZoomMode;
         d->zoomFactor = newFactor;
@@ -4222,6 +4326,7 @@ void PageView::slotRelayoutPages()
         return;
     }
 
+    const int krowHeightMargin = d->pagePaddings;
     int viewportWidth = viewport()->width(), viewportHeight = viewport()->height(), fullWidth = 0, fullHeight = 0;
 
     // handle the 'center first page in row' stuff
@@ -4265,28 +4370,10 @@ void PageView::slotRelayoutPages()
             colWidth[cIdx] = item->croppedWidth() + kcolWidthMargin;
         if (item->croppedHeight() + krowHeightMargin > rowHeight[rIdx])
             rowHeight[rIdx] = item->croppedHeight() + krowHeightMargin;
-        // handle the 'centering on first row' stuff
-        if ( centerFirstPage )
-            cIdx += nCols - 1;
-
-        const int krowHeightMargin = d->pagePaddings;
-        // 1) find the maximum columns width and rows height for a grid in
-        // which each page must well-fit inside a cell
-        for ( PageViewItem * item : qAsConst( d->items ) )
-        {
-            // update internal page size (leaving a little margin in case of Fit* modes)
-            updateItemSize( item, colWidth[ cIdx ] - kcolWidthMargin, viewportHeight - krowHeightMargin );
-            // find row's maximum height and column's max width
-            if ( item->croppedWidth() + kcolWidthMargin > colWidth[ cIdx ] )
-                colWidth[ cIdx ] = item->croppedWidth() + kcolWidthMargin;
-            if ( item->croppedHeight() + krowHeightMargin > rowHeight[ rIdx ] )
-                rowHeight[ rIdx ] = item->croppedHeight() + krowHeightMargin;
-            // handle the 'centering on first row' stuff
-            // update col/row indices
-            if (++cIdx == nCols) {
-                cIdx = 0;
-                rIdx++;
-            }
+        // update col/row indices
+        if (++cIdx == nCols) {
+            cIdx = 0;
+            rIdx++;
         }
     }
 
@@ -4304,6 +4391,18 @@ void PageView::slotRelayoutPages()
     // 3) arrange widgets inside cells (and refine fullHeight if needed)
     int insertX = 0, insertY = fullHeight < viewportHeight ? (viewportHeight - fullHeight) / 2 : 0;
     const int origInsertY = insertY;
+
+    // keep the rows tops, so that the items in an area can be found
+    // without checking all of them
+    d->rowTops.resize(nRows + 1);
+    for (int i = 0; i < nRows; i++)
+        d->rowTops[i] = i > 0 ? d->rowTops[i - 1] + rowHeight[i - 1] : origInsertY;
+    d->rowTops[nRows] = d->rowTops[nRows - 1] + rowHeight[nRows - 1];
+    d->layoutColumns = nCols;
+    d->layoutFirstColumn = centerFirstPage ? nCols - 1 : 0;
+    d->layoutCurrentRow = continuousView ? -1 : pageRowIdx;
+    // the widgets of all the items have been moved, they all need to be placed
+    d->widgetsFirstItem = -1;
     cIdx = 0;
     rIdx = 0;
     if (centerFirstPage) {
@@ -4404,7 +4503,7 @@ void PageView::delayedResizeEvent()
     slotRequestVisiblePixmaps();
 }
 
-static void slotRequestPreloadPixmap(Okular::DocumentObserver *observer, const PageViewItem *i, const QRect expandedViewportRect, QLinkedList<Okular::PixmapRequest *> *requestedPixmaps)
+static void slotRequestPreloadPixmap(Okular::DocumentObserver *observer, const PageViewItem *i, const QRect expandedViewportRect, int priority, QLinkedList<Okular::PixmapRequest *> *requestedPixmaps)
 {
     Okular::NormalizedRect preRenderRegion;
     const QRect intersectionRect = expandedViewportRect.intersected(i->croppedGeometry());
@@ -4417,13 +4516,13 @@ static void slotRequestPreloadPixmap(Okular::DocumentObserver *observer, const P
         requestFeatures |= Okular::PixmapRequest::Asynchronous;
         const bool pageHasTilesManager = i->page()->hasTilesManager(observer);
         if (pageHasTilesManager && !preRenderRegion.isNull()) {
-            Okular::PixmapRequest *p = new Okular::PixmapRequest(observer, i->pageNumber(), i->uncroppedWidth(), i->uncroppedHeight(), PAGEVIEW_PRELOAD_PRIO, requestFeatures);
+            Okular::PixmapRequest *p = new Okular::PixmapRequest(observer, i->pageNumber(), i->uncroppedWidth(), i->uncroppedHeight(), priority, requestFeatures);
             requestedPixmaps->push_back(p);
 
             p->setNormalizedRect(preRenderRegion);
             p->setTile(true);
         } else if (!pageHasTilesManager) {
-            Okular::PixmapRequest *p = new Okular::PixmapRequest(observer, i->pageNumber(), i->uncroppedWidth(), i->uncroppedHeight(), PAGEVIEW_PRELOAD_PRIO, requestFeatures);
+            Okular::PixmapRequest *p = new Okular::PixmapRequest(observer, i->pageNumber(), i->uncroppedWidth(), i->uncroppedHeight(), priority, requestFeatures);
             requestedPixmaps->push_back(p);
             p->setNormalizedRect(preRenderRegion);
         }
@@ -4449,11 +4548,24 @@ void PageView::slotRequestVisiblePixmaps(int newValue)
     // Margin (in pixels) around the viewport to preload
     const int pixelsToExpand = 512;
 
-    // iterate over all items
-    d->visibleItems.clear();
-    QLinkedList<Okular::PixmapRequest *> requestedPixmaps;
-    QVector<Okular::VisiblePageRect *> visibleRects;
-    for (PageViewItem *i : qAsConst(d->items)) {
+    // the preloading goes further in the reading direction the faster the view scrolls,
+    // and less far behind: 1 is towards the next pages, -1 towards the previous ones.
+    // Scrolling sideways only moves between pages when they are laid out in columns,
+    // from right to left in RTL mode; otherwise it pans within the same pages
+    if (isEvent)
+        d->updateScrollVelocity(viewportRect.topLeft());
+    const QPointF scrollVelocity = d->currentScrollVelocity();
+    int readingDirection = 0;
+    if (qAbs(scrollVelocity.y()) >= qAbs(scrollVelocity.x()))
+        readingDirection = scrollVelocity.y() > 0 ? 1 : scrollVelocity.y() < 0 ? -1 : 0;
+    else if (viewColumns() > 1)
+        readingDirection = (scrollVelocity.x() > 0) != d->rtl_Mode ? 1 : -1;
+    const int pixelsToLookAhead = qMin(qMax(qAbs(scrollVelocity.x()), qAbs(scrollVelocity.y())) * PRELOAD_LOOKAHEAD_TIME, 4.0 * viewportRect.height());
+    const int pixelsToExpandAbove = readingDirection < 0 ? pixelsToExpand + pixelsToLookAhead : readingDirection > 0 ? pixelsToExpand / 2 : pixelsToExpand;
+    const int pixelsToExpandBelow = readingDirection > 0 ? pixelsToExpand + pixelsToLookAhead : readingDirection < 0 ? pixelsToExpand / 2 : pixelsToExpand;
+
+    // place the form and video widgets of an item in the viewport
+    const auto moveItemWidgets = [&viewportRect, &viewportRectAtZeroZero](PageViewItem *i) {
         const QSet<FormWidgetIface *> formWidgetsList = i->formWidgets();
         for (FormWidgetIface *fwi : formWidgetsList) {
             Okular::NormalizedRect r = fwi->rect();
@@ -4469,6 +4581,35 @@ void PageView::slotRequestVisiblePixmaps(int newValue)
                 vw->pageLeft();
             }
         }
+    };
+
+    // only the items that intersect with the viewport are checked
+    int firstItem, lastItem;
+    d->itemsInRect(viewportRect, &firstItem, &lastItem);
+
+    // the widgets of the items that were in the viewport have to be moved
+    // out of it; if all the items were moved by a relayout, place all of them
+    if (d->widgetsFirstItem == -1) {
+        for (PageViewItem *i : qAsConst(d->items))
+            moveItemWidgets(i);
+    } else {
+        for (int j = d->widgetsFirstItem; j <= d->widgetsLastItem && j < d->items.count(); ++j) {
+            if (j < firstItem || j > lastItem)
+                moveItemWidgets(d->items[j]);
+        }
+    }
+
+    // the text of the pages that are not visible anymore is not needed soon
+    d->document->cancelTextPageRequests(Okular::Document::InteractiveTextPage);
+
+    // iterate over the items in the viewport
+    d->visibleItems.clear();
+    QLinkedList<Okular::PixmapRequest *> requestedPixmaps;
+    QVector<Okular::VisiblePageRect *> visibleRects;
+    for (int j = firstItem; j <= lastItem; ++j) {
+        PageViewItem *i = d->items[j];
+        if (d->widgetsFirstItem != -1)
+            moveItemWidgets(i);
 
         if (!i->isVisible())
             continue;
@@ -4495,9 +4636,9 @@ void PageView::slotRequestVisiblePixmaps(int newValue)
         if (i->page()->hasTilesManager(this) && Okular::Settings::memoryLevel() != Okular::Settings::EnumMemoryLevel::Low) {
             double rectMargin = pixelsToExpand / (double)i->uncroppedHeight();
             expandedVisibleRect.left = qMax(0.0, vItem->rect.left - rectMargin);
-            expandedVisibleRect.top = qMax(0.0, vItem->rect.top - rectMargin);
+            expandedVisibleRect.top = qMax(0.0, vItem->rect.top - pixelsToExpandAbove / (double)i->uncroppedHeight());
             expandedVisibleRect.right = qMin(1.0, vItem->rect.right + rectMargin);
-            expandedVisibleRect.bottom = qMin(1.0, vItem->rect.bottom + rectMargin);
+            expandedVisibleRect.bottom = qMin(1.0, vItem->rect.bottom + pixelsToExpandBelow / (double)i->uncroppedHeight());
         }
 
         // if the item has not the right pixmap, add a request for it
@@ -4513,6 +4654,10 @@ void PageView::slotRequestVisiblePixmaps(int newValue)
                 p->setTile(true);
             } else
                 p->setNormalizedRect(vItem->rect);
+        } else if (!i->page()->hasTextPage()) {
+            // the text is generated together with the pixmap, if the pixmap
+            // is already there have the text ready for selecting it
+            d->document->queueTextPage(i->pageNumber(), Okular::Document::InteractiveTextPage);
         }
 
         // look for the item closest to viewport center and the relative
@@ -4532,30 +4677,49 @@ void PageView::slotRequestVisiblePixmaps(int newValue)
         }
     }
 
+    d->widgetsFirstItem = firstItem;
+    d->widgetsLastItem = lastItem;
+
     // if preloading is enabled, add the pages before and after in preloading
     if (!d->visibleItems.isEmpty() && Okular::SettingsCore::memoryLevel() != Okular::SettingsCore::EnumMemoryLevel::Low) {
         // as the requests are done in the order as they appear in the list,
-        // request first the next page and then the previous
+        // request first the page ahead in the reading direction and then the one behind
+
+        int pagesToPreloadAhead = viewColumns();
+        int pagesToPreloadBehind = viewColumns();
 
-        int pagesToPreload = viewColumns();
+        // when scrolling, preload the rows the view reaches soon, within the memory budget
+        if (readingDirection != 0) {
+            const int rowHeight = qMax(1, d->visibleItems.last()->croppedHeight());
+            const int maxRows = Okular::SettingsCore::memoryLevel() == Okular::SettingsCore::EnumMemoryLevel::Normal ? 2 : 6;
+            pagesToPreloadAhead = viewColumns() * qBound(1, 1 + pixelsToLookAhead / rowHeight, maxRows);
+        }
 
         // if the greedy option is set, preload all pages
-        if (Okular::SettingsCore::memoryLevel() == Okular::SettingsCore::EnumMemoryLevel::Greedy)
-            pagesToPreload = d->items.count();
+        if (Okular::SettingsCore::memoryLevel() == Okular::SettingsCore::EnumMemoryLevel::Greedy) {
+            pagesToPreloadAhead = d->items.count();
+            pagesToPreloadBehind = d->items.count();
+        }
 
-        const QRect expandedViewportRect = viewportRect.adjusted(0, -pixelsToExpand, 0, pixelsToExpand);
+        const int pagesToPreload = qMax(pagesToPreloadAhead, pagesToPreloadBehind);
+        const int behindPriority = readingDirection != 0 ? PAGEVIEW_PRELOAD_BEHIND_PRIO : PAGEVIEW_PRELOAD_PRIO;
+        const QRect expandedViewportRect = viewportRect.adjusted(0, -pixelsToExpandAbove, 0, pixelsToExpandBelow);
 
         for (int j = 1; j <= pagesToPreload; j++) {
-            // add the page after the 'visible series' in preload
+            // the pages after the 'visible series' are ahead, unless scrolling back
             const int tailRequest = d->visibleItems.last()->pageNumber() + j;
-            if (tailRequest < (int)d->items.count()) {
-                slotRequestPreloadPixmap(this, d->items[tailRequest], expandedViewportRect, &requestedPixmaps);
+            const int headRequest = d->visibleItems.first()->pageNumber() - j;
+            const int aheadRequest = readingDirection < 0 ? headRequest : tailRequest;
+            const int behindRequest = readingDirection < 0 ? tailRequest : headRequest;
+
+            // add the page ahead in preload
+            if (j <= pagesToPreloadAhead && aheadRequest >= 0 && aheadRequest < (int)d->items.count()) {
+                slotRequestPreloadPixmap(this, d->items[aheadRequest], expandedViewportRect, PAGEVIEW_PRELOAD_PRIO, &requestedPixmaps);
             }
 
-            // add the page before the 'visible series' in preload
-            const int headRequest = d->visibleItems.first()->pageNumber() - j;
-            if (headRequest >= 0) {
-                slotRequestPreloadPixmap(this, d->items[headRequest], expandedViewportRect, &requestedPixmaps);
+            // add the page behind in preload
+            if (j <= pagesToPreloadBehind && behindRequest >= 0 && behindRequest < (int)d->items.count()) {
+                slotRequestPreloadPixmap(this, d->items[behindRequest], expandedViewportRect, behindPriority, &requestedPixmaps);
             }
 
             // stop if we've already reached both ends of the document
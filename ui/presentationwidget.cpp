@@ -296,6 +296,9 @@ PresentationWidget::~PresentationWidget()
         m_document->resetSearch(PRESENTATION_SEARCH_ID);
     }
 
+    // drop the annotation layers painted for us
+    PagePainter::clearAnnotationLayers(this);
+
     // remove this widget from document observer
     m_document->removeObserver(this);
 
@@ -320,6 +323,8 @@ void PresentationWidget::notifySetup(const QVector<Okular::Page *> &pageSet, int
     if (!(setupFlags & Okular::DocumentObserver::DocumentChanged))
         return;
 
+    PagePainter::clearAnnotationLayers(this);
+
     // delete previous frames (if any (shouldn't be))
     qDeleteAll(m_frames);
     if (!m_frames.isEmpty())
@@ -384,6 +389,9 @@ void PresentationWidget::notifyViewportChanged(bool /*smoothMove*/)
 
 void PresentationWidget::notifyPageChanged(int pageNumber, int changedFlags)
 {
+    if (changedFlags & DocumentObserver::Annotations)
+        PagePainter::invalidateAnnotationLayers(m_document->page(pageNumber));
+
     // if we are blocking the notifications, do nothing
     if (m_blockNotifications)
         return;
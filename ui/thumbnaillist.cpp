@@ -13,6 +13,7 @@
 #include <QAction>
 #include <QApplication>
 #include <QDesktopWidget>
+#include <QHash>
 #include <QIcon>
 #include <QPainter>
 #include <QResizeEvent>
@@ -38,6 +39,8 @@
 #include "priorities.h"
 #include "settings.h"
 
+#include <algorithm>
+
 class ThumbnailWidget;
 
 ThumbnailsBox::ThumbnailsBox(QWidget *parent)
@@ -74,7 +77,15 @@ public:
     ThumbnailWidget *m_selected;
     QTimer *m_delayTimer;
     QPixmap *m_bookmarkOverlay;
-    QVector<ThumbnailWidget *> m_thumbnails;
+    // the shown pages, sorted by number
+    QVector<const Okular::Page *> m_pages;
+    // the top of the thumbnail of each shown page, followed by the height
+    // of all the thumbnails (spacing included)
+    QVector<int> m_thumbnailTops;
+    int m_thumbnailsWidth;
+    // the existing thumbnails, by page number: only the visible ones, the
+    // selected one and the grabbed one are kept
+    QHash<int, ThumbnailWidget *> m_thumbnails;
     QList<ThumbnailWidget *> m_visibleThumbnails;
     int m_vectorIndex;
     // Grabbing variables
@@ -89,17 +100,28 @@ public:
     // called by ThumbnailWidgets to send (forward) the mouse move signals
     ChangePageDirection forwardTrack(const QPoint, const QSize);
 
-    ThumbnailWidget *itemFor(const QPoint p) const;
+    ThumbnailWidget *itemFor(const QPoint p);
     void delayedRequestVisiblePixmaps(int delayMs = 0);
 
+    // computes the position of the thumbnails of all the shown pages
+    void layoutThumbnails(int width);
+    // the height of all the thumbnails
+    int thumbnailsHeight() const;
+    // the index of the page in m_pages, or -1 if it is not shown
+    int indexOfPage(int pageNumber) const;
+    // the indexes of the first and last thumbnails that can intersect with rect
+    void thumbnailsIn(const QRect &rect, int *first, int *last) const;
+    // the thumbnail of the index-th shown page, created if needed
+    ThumbnailWidget *thumbnailAt(int index);
+
     // SLOTS:
     // make requests for generating pixmaps for visible thumbnails
     void slotRequestVisiblePixmaps();
     // delay timeout: resize overlays and requests pixmaps
     void slotDelayTimeout();
-    ThumbnailWidget *getPageByNumber(int page) const;
+    ThumbnailWidget *getPageByNumber(int page);
     int getNewPageOffset(int n, ThumbnailListPrivate::ChangePageDirection dir) const;
-    ThumbnailWidget *getThumbnailbyOffset(int current, int offset) const;
+    ThumbnailWidget *getThumbnailbyOffset(int current, int offset);
 
 protected:
     void mousePressEvent(QMouseEvent *e) override;
@@ -118,6 +140,11 @@ public:
 
     // set internal parameters to fit the page in the given width
     void resizeFitWidth(int width);
+    // the height of the thumbnail of page for the given width
+    static int heightForWidth(const Okular::Page *page, int width, int labelHeight)
+    {
+        return qRound(page->ratio() * (double)(width - m_margin)) + labelHeight + m_margin;
+    }
     // set thumbnail's selected state
     void setSelected(bool selected);
     // set the visible rect of the current page
@@ -206,32 +233,32 @@ ThumbnailListPrivate::ThumbnailListPrivate(ThumbnailList *qq, Okular::Document *
     , m_selected(nullptr)
     , m_delayTimer(nullptr)
     , m_bookmarkOverlay(nullptr)
+    , m_thumbnailsWidth(0)
     , m_vectorIndex(0)
 {
     setMouseTracking(true);
     m_mouseGrabItem = nullptr;
 }
 
-ThumbnailWidget *ThumbnailListPrivate::getPageByNumber(int page) const
+ThumbnailWidget *ThumbnailListPrivate::getPageByNumber(int page)
 {
-    QVector<ThumbnailWidget *>::const_iterator tIt = m_thumbnails.constBegin(), tEnd = m_thumbnails.constEnd();
-    for (; tIt != tEnd; ++tIt) {
-        if ((*tIt)->pageNumber() == page)
-            return (*tIt);
-    }
-    return nullptr;
+    const int index = indexOfPage(page);
+    return index != -1 ? thumbnailAt(index) : nullptr;
 }
 
 ThumbnailListPrivate::~ThumbnailListPrivate()
 {
+    qDeleteAll(m_thumbnails);
 }
 
-ThumbnailWidget *ThumbnailListPrivate::itemFor(const QPoint p) const
+ThumbnailWidget *ThumbnailListPrivate::itemFor(const QPoint p)
 {
-    QVector<ThumbnailWidget *>::const_iterator tIt = m_thumbnails.constBegin(), tEnd = m_thumbnails.constEnd();
-    for (; tIt != tEnd; ++tIt) {
-        if ((*tIt)->rect().contains(p))
-            return (*tIt);
+    int first, last;
+    thumbnailsIn(QRect(p, p), &first, &last);
+    for (int i = first; i <= last; ++i) {
+        ThumbnailWidget *t = thumbnailAt(i);
+        if (t->rect().contains(p))
+            return t;
     }
     return nullptr;
 }
@@ -239,19 +266,84 @@ ThumbnailWidget *ThumbnailListPrivate::itemFor(const QPoint p) const
 void ThumbnailListPrivate::paintEvent(QPaintEvent *e)
 {
     QPainter painter(this);
-    QVector<ThumbnailWidget *>::const_iterator tIt = m_thumbnails.constBegin(), tEnd = m_thumbnails.constEnd();
-    for (; tIt != tEnd; ++tIt) {
-        QRect rect = e->rect().intersected((*tIt)->rect());
+    int first, last;
+    thumbnailsIn(e->rect(), &first, &last);
+    for (int i = first; i <= last; ++i) {
+        ThumbnailWidget *t = thumbnailAt(i);
+        QRect rect = e->rect().intersected(t->rect());
         if (!rect.isNull()) {
-            rect.translate(-(*tIt)->pos());
+            rect.translate(-t->pos());
             painter.save();
-            painter.translate((*tIt)->pos());
-            (*tIt)->paint(painter, rect);
+            painter.translate(t->pos());
+            t->paint(painter, rect);
             painter.restore();
         }
     }
 }
 
+void ThumbnailListPrivate::layoutThumbnails(int width)
+{
+    const int spacing = style()->layoutSpacing(QSizePolicy::Frame, QSizePolicy::Frame, Qt::Vertical);
+    const int labelHeight = QFontMetrics(font()).height();
+
+    // only the heights are needed, so no thumbnail is created here
+    m_thumbnailsWidth = width;
+    m_thumbnailTops.resize(m_pages.count() + 1);
+    int top = 0;
+    for (int i = 0; i < m_pages.count(); ++i) {
+        m_thumbnailTops[i] = top;
+        top += ThumbnailWidget::heightForWidth(m_pages[i], width, labelHeight) + spacing;
+    }
+    m_thumbnailTops[m_pages.count()] = top;
+
+    for (ThumbnailWidget *t : qAsConst(m_thumbnails)) {
+        t->resizeFitWidth(width);
+        t->move(0, m_thumbnailTops[indexOfPage(t->pageNumber())]);
+    }
+}
+
+int ThumbnailListPrivate::thumbnailsHeight() const
+{
+    if (m_pages.isEmpty())
+        return 0;
+    return m_thumbnailTops.last() - style()->layoutSpacing(QSizePolicy::Frame, QSizePolicy::Frame, Qt::Vertical);
+}
+
+int ThumbnailListPrivate::indexOfPage(int pageNumber) const
+{
+    QVector<const Okular::Page *>::const_iterator it = std::lower_bound(m_pages.constBegin(), m_pages.constEnd(), pageNumber, [](const Okular::Page *page, int number) { return (int)page->number() < number; });
+    if (it == m_pages.constEnd() || (int)(*it)->number() != pageNumber)
+        return -1;
+    return it - m_pages.constBegin();
+}
+
+void ThumbnailListPrivate::thumbnailsIn(const QRect &rect, int *first, int *last) const
+{
+    if (m_pages.isEmpty()) {
+        *first = 0;
+        *last = -1;
+        return;
+    }
+
+    // the thumbnails starting right above the top and the bottom of the rect
+    QVector<int>::const_iterator topsEnd = m_thumbnailTops.constEnd() - 1;
+    *first = qMax(0, int(std::upper_bound(m_thumbnailTops.constBegin(), topsEnd, rect.top()) - m_thumbnailTops.constBegin()) - 1);
+    *last = int(std::upper_bound(m_thumbnailTops.constBegin(), topsEnd, rect.bottom()) - m_thumbnailTops.constBegin()) - 1;
+}
+
+ThumbnailWidget *ThumbnailListPrivate::thumbnailAt(int index)
+{
+    const Okular::Page *page = m_pages[index];
+    ThumbnailWidget *t = m_thumbnails.value(page->number());
+    if (!t) {
+        t = new ThumbnailWidget(this, page);
+        t->resizeFitWidth(m_thumbnailsWidth);
+        t->move(0, m_thumbnailTops[index]);
+        m_thumbnails.insert(page->number(), t);
+    }
+    return t;
+}
+
 /** ThumbnailList implementation **/
 
 ThumbnailList::ThumbnailList(QWidget *parent, Okular::Document *document)
@@ -289,25 +381,13 @@ void ThumbnailList::notifySetup(const QVector<Okular::Page *> &pages, int setupF
     // if there was a widget selected, save its pagenumber to restore
     // its selection (if available in the new set of pages)
     int prevPage = -1;
+    if (setupFlags & Okular::DocumentObserver::DocumentChanged)
+        PagePainter::clearAnnotationLayers(this);
     if (!(setupFlags & Okular::DocumentObserver::DocumentChanged) && d->m_selected) {
         prevPage = d->m_selected->page()->number();
     } else
         prevPage = d->m_document->viewport().pageNumber;
 
-    // delete all the Thumbnails
-    QVector<ThumbnailWidget *>::const_iterator tIt = d->m_thumbnails.constBegin(), tEnd = d->m_thumbnails.constEnd();
-    for (; tIt != tEnd; ++tIt)
-        delete *tIt;
-    d->m_thumbnails.clear();
-    d->m_visibleThumbnails.clear();
-    d->m_selected = nullptr;
-    d->m_mouseGrabItem = nullptr;
-
-    if (pages.count() < 1) {
-        widget()->resize(0, 0);
-        return;
-    }
-
     // show pages containing highlighted text or bookmarked ones
     // RESTORE THIS int flags = Okular::Settings::filterBookmarks() ? Okular::Page::Bookmark : Okular::Page::Highlight;
 
@@ -319,33 +399,62 @@ void ThumbnailList::notifySetup(const QVector<Okular::Page *> &pages, int setupF
         if ((*pIt)->hasHighlights(SW_SEARCH_ID))
             skipCheck = false;
 
-    // generate Thumbnails for the given set of pages
-    const int width = viewport()->width();
-    int height = 0;
-    int centerHeight = 0;
+    QVector<const Okular::Page *> shownPages;
     for (pIt = pages.constBegin(); pIt != pEnd; ++pIt)
         // if ( skipCheck || (*pIt)->attributes() & flags )
-        if (skipCheck || (*pIt)->hasHighlights(SW_SEARCH_ID)) {
-            ThumbnailWidget *t = new ThumbnailWidget(d, *pIt);
-            t->move(0, height);
-            // add to the internal queue
-            d->m_thumbnails.push_back(t);
-            // update total height (asking widget its own height)
-            t->resizeFitWidth(width);
-            // restoring the previous selected page, if any
-            if ((*pIt)->number() < prevPage) {
-                centerHeight = height + t->height() + this->style()->layoutSpacing(QSizePolicy::Frame, QSizePolicy::Frame, Qt::Vertical) / 2;
-            }
-            if ((*pIt)->number() == prevPage) {
-                d->m_selected = t;
-                d->m_selected->setSelected(true);
-                centerHeight = height + t->height() / 2;
-            }
-            height += t->height() + this->style()->layoutSpacing(QSizePolicy::Frame, QSizePolicy::Frame, Qt::Vertical);
+        if (skipCheck || (*pIt)->hasHighlights(SW_SEARCH_ID))
+            shownPages.push_back(*pIt);
+
+    // same pages with the same layout (e.g. after a search), just repaint
+    // the visible thumbnails for the new highlights
+    if (!(setupFlags & (Okular::DocumentObserver::DocumentChanged | Okular::DocumentObserver::NewLayoutForPages)) && shownPages == d->m_pages) {
+        updateWidgets();
+        return;
+    }
+
+    // delete the thumbnails of the pages that are not shown anymore, the
+    // other ones are moved to their new place
+    d->m_pages = shownPages;
+    QHash<int, ThumbnailWidget *>::iterator tIt = d->m_thumbnails.begin();
+    while (tIt != d->m_thumbnails.end()) {
+        const int index = d->indexOfPage(tIt.key());
+        if (setupFlags & Okular::DocumentObserver::DocumentChanged || index == -1 || d->m_pages[index] != tIt.value()->page()) {
+            delete tIt.value();
+            tIt = d->m_thumbnails.erase(tIt);
+        } else {
+            tIt.value()->setSelected(false);
+            ++tIt;
         }
+    }
+    d->m_visibleThumbnails.clear();
+    d->m_selected = nullptr;
+    d->m_mouseGrabItem = nullptr;
+
+    if (d->m_pages.isEmpty()) {
+        d->m_thumbnailTops.clear();
+        widget()->resize(0, 0);
+        return;
+    }
+
+    // lay out the thumbnails for the given set of pages
+    const int width = viewport()->width();
+    d->layoutThumbnails(width);
+    const int height = d->thumbnailsHeight();
+
+    // restoring the previous selected page, if any
+    int centerHeight = 0;
+    const int spacing = this->style()->layoutSpacing(QSizePolicy::Frame, QSizePolicy::Frame, Qt::Vertical);
+    const int nextIndex = std::lower_bound(d->m_pages.constBegin(), d->m_pages.constEnd(), prevPage, [](const Okular::Page *page, int number) { return (int)page->number() < number; }) - d->m_pages.constBegin();
+    if (nextIndex < d->m_pages.count() && (int)d->m_pages[nextIndex]->number() == prevPage) {
+        d->m_selected = d->thumbnailAt(nextIndex);
+        d->m_selected->setSelected(true);
+        d->m_vectorIndex = nextIndex;
+        centerHeight = d->m_thumbnailTops[nextIndex] + d->m_selected->height() / 2;
+    } else if (nextIndex > 0) {
+        centerHeight = d->m_thumbnailTops[nextIndex] - spacing + spacing / 2;
+    }
 
     // update scrollview's contents size (sets scrollbars limits)
-    height -= this->style()->layoutSpacing(QSizePolicy::Frame, QSizePolicy::Frame, Qt::Vertical);
     widget()->resize(width, height);
 
     // enable scrollbar when there's something to scroll
@@ -370,19 +479,15 @@ void ThumbnailList::notifyCurrentPageChanged(int previousPage, int currentPage)
     d->m_selected = nullptr;
 
     // select the page with viewport and ensure it's centered in the view
-    d->m_vectorIndex = 0;
-    QVector<ThumbnailWidget *>::const_iterator tIt = d->m_thumbnails.constBegin(), tEnd = d->m_thumbnails.constEnd();
-    for (; tIt != tEnd; ++tIt) {
-        if ((*tIt)->pageNumber() == currentPage) {
-            d->m_selected = *tIt;
-            d->m_selected->setSelected(true);
-            if (Okular::Settings::syncThumbnailsViewport()) {
-                int yOffset = qMax(viewport()->height() / 4, d->m_selected->height() / 2);
-                ensureVisible(0, d->m_selected->pos().y() + d->m_selected->height() / 2, 0, yOffset);
-            }
-            break;
+    const int index = d->indexOfPage(currentPage);
+    d->m_vectorIndex = index != -1 ? index : d->m_pages.count();
+    if (index != -1) {
+        d->m_selected = d->thumbnailAt(index);
+        d->m_selected->setSelected(true);
+        if (Okular::Settings::syncThumbnailsViewport()) {
+            int yOffset = qMax(viewport()->height() / 4, d->m_selected->height() / 2);
+            ensureVisible(0, d->m_selected->pos().y() + d->m_selected->height() / 2, 0, yOffset);
         }
-        d->m_vectorIndex++;
     }
 }
 
@@ -393,6 +498,9 @@ void ThumbnailList::notifyPageChanged(int pageNumber, int changedFlags)
     if (!(changedFlags & interestingFlags))
         return;
 
+    if (changedFlags & DocumentObserver::Annotations)
+        PagePainter::invalidateAnnotationLayers(d->m_document->page(pageNumber));
+
     // iterate over visible items: if page(pageNumber) is one of them, repaint it
     QList<ThumbnailWidget *>::const_iterator vIt = d->m_visibleThumbnails.constBegin(), vEnd = d->m_visibleThumbnails.constEnd();
     for (; vIt != vEnd; ++vIt)
@@ -411,9 +519,10 @@ void ThumbnailList::notifyContentsCleared(int changedFlags)
 
 void ThumbnailList::notifyVisibleRectsChanged()
 {
+    // only the existing thumbnails, new ones get their visible rect when created
     bool found = false;
     const QVector<Okular::VisiblePageRect *> &visibleRects = d->m_document->visiblePageRects();
-    QVector<ThumbnailWidget *>::const_iterator tIt = d->m_thumbnails.constBegin(), tEnd = d->m_thumbnails.constEnd();
+    QHash<int, ThumbnailWidget *>::const_iterator tIt = d->m_thumbnails.constBegin(), tEnd = d->m_thumbnails.constEnd();
     QVector<Okular::VisiblePageRect *>::const_iterator vEnd = visibleRects.end();
     for (; tIt != tEnd; ++tIt) {
         found = false;
@@ -477,23 +586,15 @@ int ThumbnailListPrivate::getNewPageOffset(int n, ThumbnailListPrivate::ChangePa
     return 0;
 }
 
-ThumbnailWidget *ThumbnailListPrivate::getThumbnailbyOffset(int current, int offset) const
+ThumbnailWidget *ThumbnailListPrivate::getThumbnailbyOffset(int current, int offset)
 {
-    QVector<ThumbnailWidget *>::const_iterator it = m_thumbnails.begin();
-    QVector<ThumbnailWidget *>::const_iterator itE = m_thumbnails.end();
-    int idx = 0;
-    while (it != itE) {
-        if ((*it)->pageNumber() == current)
-            break;
-        ++idx;
-        ++it;
-    }
-    if (it == itE)
+    int idx = indexOfPage(current);
+    if (idx == -1)
         return nullptr;
     idx += offset;
-    if (idx < 0 || idx >= m_thumbnails.size())
+    if (idx < 0 || idx >= m_pages.size())
         return nullptr;
-    return m_thumbnails[idx];
+    return thumbnailAt(idx);
 }
 
 ThumbnailListPrivate::ChangePageDirection ThumbnailListPrivate::forwardTrack(const QPoint point, const QSize r)
@@ -534,7 +635,7 @@ void ThumbnailList::slotFilterBookmarks(bool filterOn)
 // BEGIN widget events
 void ThumbnailList::keyPressEvent(QKeyEvent *keyEvent)
 {
-    if (d->m_thumbnails.count() < 1) {
+    if (d->m_pages.count() < 1) {
         keyEvent->ignore();
         return;
     }
@@ -544,20 +645,20 @@ void ThumbnailList::keyPressEvent(QKeyEvent *keyEvent)
         if (!d->m_selected)
             nextPage = 0;
         else if (d->m_vectorIndex > 0)
-            nextPage = d->m_thumbnails[d->m_vectorIndex - 1]->pageNumber();
+            nextPage = d->m_pages[d->m_vectorIndex - 1]->number();
     } else if (keyEvent->key() == Qt::Key_Down) {
         if (!d->m_selected)
             nextPage = 0;
-        else if (d->m_vectorIndex < (int)d->m_thumbnails.count() - 1)
-            nextPage = d->m_thumbnails[d->m_vectorIndex + 1]->pageNumber();
+        else if (d->m_vectorIndex < (int)d->m_pages.count() - 1)
+            nextPage = d->m_pages[d->m_vectorIndex + 1]->number();
     } else if (keyEvent->key() == Qt::Key_PageUp)
         verticalScrollBar()->triggerAction(QScrollBar::SliderPageStepSub);
     else if (keyEvent->key() == Qt::Key_PageDown)
         verticalScrollBar()->triggerAction(QScrollBar::SliderPageStepAdd);
     else if (keyEvent->key() == Qt::Key_Home)
-        nextPage = d->m_thumbnails[0]->pageNumber();
+        nextPage = d->m_pages[0]->number();
     else if (keyEvent->key() == Qt::Key_End)
-        nextPage = d->m_thumbnails[d->m_thumbnails.count() - 1]->pageNumber();
+        nextPage = d->m_pages[d->m_pages.count() - 1]->number();
 
     if (nextPage == -1) {
         keyEvent->ignore();
@@ -585,7 +686,7 @@ bool ThumbnailList::viewportEvent(QEvent *e)
 
 void ThumbnailListPrivate::viewportResizeEvent(QResizeEvent *e)
 {
-    if (m_thumbnails.count() < 1 || width() < 1)
+    if (m_pages.count() < 1 || width() < 1)
         return;
 
     // if width changed resize all the Thumbnails, reposition them to the
@@ -596,17 +697,10 @@ void ThumbnailListPrivate::viewportResizeEvent(QResizeEvent *e)
 
         // resize and reposition items
         const int newWidth = q->viewport()->width();
-        int newHeight = 0;
-        QVector<ThumbnailWidget *>::const_iterator tIt = m_thumbnails.constBegin(), tEnd = m_thumbnails.constEnd();
-        for (; tIt != tEnd; ++tIt) {
-            ThumbnailWidget *t = *tIt;
-            t->move(0, newHeight);
-            t->resizeFitWidth(newWidth);
-            newHeight += t->height() + this->style()->layoutSpacing(QSizePolicy::Frame, QSizePolicy::Frame, Qt::Vertical);
-        }
+        layoutThumbnails(newWidth);
 
         // update scrollview's contents size (sets scrollbars limits)
-        newHeight -= this->style()->layoutSpacing(QSizePolicy::Frame, QSizePolicy::Frame, Qt::Vertical);
+        const int newHeight = thumbnailsHeight();
         const int oldHeight = q->widget()->height();
         const int oldYCenter = q->verticalScrollBar()->value() + q->viewport()->height() / 2;
         q->widget()->resize(newWidth, newHeight);
@@ -637,13 +731,14 @@ void ThumbnailListPrivate::slotRequestVisiblePixmaps()
     if ((m_delayTimer && m_delayTimer->isActive()) || q->isHidden())
         return;
 
-    // scroll from the top to the last visible thumbnail
+    // go from the first to the last visible thumbnail
     m_visibleThumbnails.clear();
     QLinkedList<Okular::PixmapRequest *> requestedPixmaps;
-    QVector<ThumbnailWidget *>::const_iterator tIt = m_thumbnails.constBegin(), tEnd = m_thumbnails.constEnd();
     const QRect viewportRect = q->viewport()->rect().translated(q->horizontalScrollBar()->value(), q->verticalScrollBar()->value());
-    for (; tIt != tEnd; ++tIt) {
-        ThumbnailWidget *t = *tIt;
+    int first, last;
+    thumbnailsIn(viewportRect, &first, &last);
+    for (int i = first; i <= last; ++i) {
+        ThumbnailWidget *t = thumbnailAt(i);
         const QRect thumbRect = t->rect();
         if (!thumbRect.intersects(viewportRect))
             continue;
@@ -656,6 +751,18 @@ void ThumbnailListPrivate::slotRequestVisiblePixmaps()
         }
     }
 
+    // delete the thumbnails that are not needed anymore
+    QHash<int, ThumbnailWidget *>::iterator it = m_thumbnails.begin();
+    while (it != m_thumbnails.end()) {
+        ThumbnailWidget *t = it.value();
+        if (t != m_selected && t != m_mouseGrabItem && !m_visibleThumbnails.contains(t)) {
+            delete t;
+            it = m_thumbnails.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
     // actually request pixmaps
     if (!requestedPixmaps.isEmpty())
         m_document->requestPixmaps(requestedPixmaps);
@@ -697,6 +804,16 @@ ThumbnailWidget::ThumbnailWidget(ThumbnailListPrivate *parent, const Okular::Pag
 {
     m_labelNumber = m_page->number() + 1;
     m_labelHeight = QFontMetrics(m_parent->font()).height();
+
+    // thumbnails are created when they are needed, so the visible rect
+    // of the page may be already known
+    const QVector<Okular::VisiblePageRect *> &visibleRects = m_parent->m_document->visiblePageRects();
+    for (const Okular::VisiblePageRect *visibleRect : visibleRects) {
+        if (visibleRect->pageNumber == (int)m_page->number()) {
+            m_visibleRect = visibleRect->rect;
+            break;
+        }
+    }
 }
 
 void ThumbnailWidget::resizeFitWidth(int width)
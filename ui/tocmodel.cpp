@@ -10,6 +10,7 @@
 #include "tocmodel.h"
 
 #include <QApplication>
+#include <QHash>
 #include <QList>
 #include <QTreeView>
 #include <qdom.h>
@@ -56,6 +57,8 @@ public:
     Okular::Document *document;
     QList<TOCItem *> itemsToOpen;
     QList<TOCItem *> currentPage;
+    // the items to highlight for each page, as found by findViewport
+    QHash<int, QList<TOCItem *>> pagePaths;
     TOCModel *m_oldModel;
     QVector<QModelIndex> m_oldTocExpandedIndexes;
 };
@@ -322,6 +325,7 @@ void TOCModel::fill(const Okular::DocumentSynopsis *toc)
     clear();
     emit layoutAboutToBeChanged();
     d->addChildren(*toc, d->root);
+    d->pagePaths.clear();
     d->dirty = true;
     emit layoutChanged();
     if (equals(d->m_oldModel)) {
@@ -358,34 +362,49 @@ void TOCModel::clear()
     qDeleteAll(d->root->children);
     d->root->children.clear();
     d->currentPage.clear();
+    d->pagePaths.clear();
     endResetModel();
     d->dirty = false;
 }
 
 void TOCModel::setCurrentViewport(const Okular::DocumentViewport &viewport)
 {
-    for (TOCItem *item : qAsConst(d->currentPage)) {
-        QModelIndex index = d->indexForItem(item);
-        if (!index.isValid())
-            continue;
-
-        item->highlight = false;
-        emit dataChanged(index, index);
+    // the items to highlight only depend on the page
+    QHash<int, QList<TOCItem *>>::const_iterator pathIt = d->pagePaths.constFind(viewport.pageNumber);
+    if (pathIt == d->pagePaths.constEnd()) {
+        QList<TOCItem *> newCurrentPage;
+        d->findViewport(viewport, d->root, newCurrentPage);
+        pathIt = d->pagePaths.insert(viewport.pageNumber, newCurrentPage);
     }
-    d->currentPage.clear();
-
-    QList<TOCItem *> newCurrentPage;
-    d->findViewport(viewport, d->root, newCurrentPage);
+    const QList<TOCItem *> &newCurrentPage = pathIt.value();
+    if (newCurrentPage == d->currentPage)
+        return;
 
+    const QList<TOCItem *> oldCurrentPage = d->currentPage;
+    TOCItem *oldLastHighlighted = oldCurrentPage.isEmpty() ? nullptr : oldCurrentPage.last();
     d->currentPage = newCurrentPage;
 
+    // only the items whose highlight changed need to be updated, and the
+    // last highlighted ones, which can have a different font
+    for (TOCItem *item : oldCurrentPage) {
+        item->highlight = false;
+    }
     for (TOCItem *item : qAsConst(d->currentPage)) {
-        QModelIndex index = d->indexForItem(item);
-        if (!index.isValid())
-            continue;
-
         item->highlight = true;
-        emit dataChanged(index, index);
+    }
+    for (TOCItem *item : oldCurrentPage) {
+        if (item->highlight && item != oldLastHighlighted)
+            continue;
+        const QModelIndex index = d->indexForItem(item);
+        if (index.isValid())
+            emit dataChanged(index, index);
+    }
+    for (TOCItem *item : qAsConst(d->currentPage)) {
+        if (oldCurrentPage.contains(item) && item != d->currentPage.last())
+            continue;
+        const QModelIndex index = d->indexForItem(item);
+        if (index.isValid())
+            emit dataChanged(index, index);
     }
 }
 